@@ -0,0 +1,55 @@
+/**
+ * @file AutoTuner.h
+ * Choose the options of the reachability analysis of a model.
+ * Candidate configurations (transformation, decompositions, alpha, threads)
+ * are run on a short probe horizon measuring the time per step and the
+ * growth of the bundle widths. The configuration that best meets the
+ * objective is stored in a per-model profile used by the production runs
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef AUTOTUNER_H_
+#define AUTOTUNER_H_
+
+#include "Common.h"
+#include "Sapo.h"
+#include "Model.h"
+
+#include <string>
+
+enum tune_objective {FASTEST,MOST_PRECISE};
+
+struct tune_probe{			// measures of a probe run
+	sapo_opt options;		// configuration
+	double time_per_step;	// wall-clock seconds per step
+	double growth;			// average growth factor of the bundle widths per step
+};
+
+class AutoTuner {
+
+private:
+
+	Model *model;				// model to tune
+	sapo_opt base;				// options not touched by the tuner
+	int probe_steps;			// horizon of the probe runs
+	tune_objective objective;	// FASTEST: fastest with growth <= target, MOST_PRECISE: smallest growth with time per step <= target
+	double target;				// precision target (growth per step) or time budget (seconds per step)
+
+	vector< sapo_opt > candidates();
+	double width(Bundle *B);
+	tune_probe probe(sapo_opt options);
+	bool better(tune_probe &p1, tune_probe &p2);
+
+public:
+
+	AutoTuner(Model *model, sapo_opt base, int probe_steps, tune_objective objective, double target);
+
+	sapo_opt tune();
+
+	static void saveProfile(string file_name, sapo_opt options);
+	static bool loadProfile(string file_name, sapo_opt &options);
+};
+
+#endif /* AUTOTUNER_H_ */
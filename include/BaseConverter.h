@@ -10,6 +10,8 @@
 #define BASECONVERTER_H_
 
 #include "Common.h"
+#include "PerfCounters.h"
+#include "Logger.h"
 #include <math.h>
 
 class BaseConverter {
@@ -0,0 +1,37 @@
+/**
+ * @file Benchmark.h
+ * Benchmark suite on synthetic models.
+ * Chart runtime and memory against dimension, degree, sparsity, coupling,
+ * number of directions, number of templates, number of parameters, and lookahead
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "Common.h"
+#include "Sapo.h"
+#include "Synthetic.h"
+
+class Benchmark {
+
+private:
+
+	sapo_opt options;		// options of the analyses
+	synthetic_opt base;		// model varied along each axis
+	int steps;				// reachability steps of each run
+	string file_name;		// file where the JSON records are appended
+
+	void run(string axis, int value, synthetic_opt opt, sapo_opt options);
+
+public:
+
+	Benchmark(sapo_opt options, synthetic_opt base, int steps, string file_name);
+
+	void sweep(string axis, vector<int> values);
+	void sweepAll();
+};
+
+#endif /* BENCHMARK_H_ */
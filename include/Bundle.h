@@ -14,18 +14,31 @@
 #include "Common.h"
 #include "BaseConverter.h"
 #include "Parallelotope.h"
+#include "Zonotope.h"
+#include "SparseMatrix.h"
 #include "LinearSystem.h"
 #include "VarsGenerator.h"
+#include "PerfCounters.h"
+#include "MemoryTracker.h"
+#include "ControlPointCache.h"
 #include <cmath>
 
+struct bound_job{						// numerical bound of a direction on a parallelotope
+	int dir;							// direction to bound
+	int par;							// parallelotope (index of its values)
+	shared_ptr<const compact_points> controlPts;	// control points of the pair
+};
+
 class Bundle {
 
 private:
 	int dim;							// dimension
 	vector< vector< double > > L;		// direction matrix
+	SparseMatrix Ls;					// direction matrix in CSR form
 	vector< double > offp;				// superior offset
 	vector< double > offm;				// inferior offset
 	vector< vector< int > > T;			// templates matrix
+	vector< shared_ptr<Zonotope> > zonotopes;	// zonotope members (immutable, shared by the bundles derived from this one)
 	vector< vector< double > > Theta;	// matrix of orthogonal proximity
 	vector<lst> vars;					// variables appearing in generato function
 										// vars[0] q: base vertex
@@ -43,9 +56,9 @@ private:
 	double prod(vector<double> v1, vector<double> v2);
 	double angle(vector<double> v1, vector<double> v2);
 	double orthProx(vector<double> v1, vector<double> v2);
+	double orthProx(int i, int j);
 	double maxOrthProx(int vIdx, vector<int> dirsIdx);
 	double maxOrthProx(vector<int> dirsIdx);
-	double maxOrthProx(vector< vector<int> > T);
 	double maxOffsetDist(int vIdx, vector<int> dirsIdx, vector<double> dists);
 	double maxOffsetDist(vector<int> dirsIdx, vector<double> dists);
 	double maxOffsetDist(vector< vector<int> > T, vector<double> dists);
@@ -57,6 +70,13 @@ private:
 
 	bool validTemp(vector< vector<int> > T, int card, vector<int> dirs);	// check if a template is valid
 	vector<lst> transformContrPts(lst vars, lst f, int mode);
+	lst bernVars(disturbance_box *dists);
+	lst cacheSymbols(lst params);
+	ex composeComponent(lst vars, lst f, int k, lst genFun, map< int, vector< pair<lst,ex> > > &composed, ControlPointCache *controlPts);
+	void maxCoefficients(const compact_points &controlPts, const vector< double > &values, LinearSystem *paraSet,
+			double &maxCoeffp, double &maxCoeffm);	// bound the control points of a pair
+	bool affineCoeffs(ex e, lst vars, lst params, lst &coeffs);		// closed-form path of the affine directions
+	double additiveBound(int dir, double sign, disturbance_box *dists);
 
 public:
 
@@ -64,26 +84,43 @@ public:
 	Bundle(vector< vector< double > > L, vector< double > offp, vector< double > offm, 	vector< vector< int > > T);
 	Bundle(vector<lst> vars, vector< vector< double > > L, vector< double > offp, vector< double > offm, 	vector< vector< int > > T);
 
+	vector< bound_job > prepareTransform(lst vars, lst params, lst f, ControlPointCache *controlPts, int mode,
+			disturbance_box *dists, vector< vector< double > > &values);	// symbolic stage of the transformations (shared with the model compiler)
+
 	int getDim(){ return this->dim; };
 	int getSize(){ return L.size(); };
 	int getCard(){ return T.size(); };
 	int getNumDirs(){ return this->L.size(); };
 
 	vector<int> getTemplate(int i){ return this->T[i]; };
+	vector< vector< double > > getDirections(){ return this->L; };
 	double getOffp(int i){ return this->offp[i]; };
 	double getOffm(int i){ return this->offm[i]; };
 	LinearSystem *getBundle();
+	string toCompact(bool with_dirs);	// one-line dump for the logger
 	Parallelotope* getParallelotope(int i);
+	vector< shared_ptr<Zonotope> > getZonotopes(){ return this->zonotopes; };
 
 	void setTemplate(vector< vector< int > > T);
 	void setOffsetP(vector< double > offp){ this->offp = offp; }
 	void setOffsetM(vector< double > offm){ this->offm = offm; }
+	void setZonotopes(vector< shared_ptr<Zonotope> > zonotopes){ this->zonotopes = zonotopes; }
+	void addZonotope(Zonotope *Z){ this->zonotopes.push_back(shared_ptr<Zonotope>(Z)); }	// the bundle takes the ownership of Z
+
+	// batch queries on points
+	vector<double> violations(const vector< vector<double> > &points);	// signed max violation of the offsets
+	vector<bool> contains(const vector< vector<double> > &points, double tol);
+
+	double maxOrthProx(vector< vector<int> > T);	// orthogonal proximity score of a template (decompose)
 
 	// operations on bundles
 	Bundle* canonize();
 	Bundle* decompose(double alpha, int max_iters);
-	Bundle* transform(lst vars, lst f, map< vector<int>,pair<lst,lst> > &controlPts, int mode);
-	Bundle* transform(lst vars, lst params, lst f, LinearSystem *paraSet, map< vector<int>,pair<lst,lst> > &controlPts, int mode);
+	Bundle* transform(lst vars, lst f, ControlPointCache *controlPts, int mode, disturbance_box *dists = NULL);
+	Bundle* transform(lst vars, lst params, lst f, LinearSystem *paraSet, ControlPointCache *controlPts, int mode, disturbance_box *dists = NULL);
+	vector< bool > activeModes(lst vars, vector< lst > guards, ControlPointCache *guardPts);	// prune the modes with Bernstein bounds of the guards
+	Bundle* transform(lst vars, lst params, vector< lst > fs, vector< lst > guards, LinearSystem *paraSet,
+			vector< ControlPointCache* > controlPts, ControlPointCache *guardPts, int mode, int &num_active);	// piecewise dynamics
 
 	virtual ~Bundle();
 };
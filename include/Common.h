@@ -13,11 +13,15 @@
 #include <iostream>
 #include <vector>
 #include <math.h>
-#include <ginac/ginac.h>
+#include <string>
 #include <algorithm>
 
 using namespace std;
+
+#ifndef SAPO_RUNTIME	// the runtime (sapo_runtime) does not link GiNaC
+#include <ginac/ginac.h>
 using namespace GiNaC;
+#endif
 
 enum formula_type {ATOM,CONJUNCTION,DISJUNCTION,UNTIL,ALWAYS,EVENTUALLY};
 
@@ -31,7 +35,30 @@ struct sapo_opt{
 	int decomp;				// number of decompositions (0: none, >0: yes)
 	string plot;			// the name of the file were to plot the reach set
 	bool verbose;			// display info
+	bool trace = false;		// log also the internals of the Bernstein conversion (very verbose)
+	int threads = 1;		// number of threads (<=0: one for each core)
+	int zonotope_gens = 0;	// generators of the zonotope member of the reach sets (0: no zonotope)
+	bool perf_counters = false;	// sample hardware performance counters
+	bool mem_report = false;	// display the memory used by each subsystem
+	string mem_metrics = "";	// file where the memory of each reach step is streamed (JSON lines)
+	int lookahead = 1;			// steps bounded at once by composing the dynamics (1: none)
+	int lookahead_degree = 0;	// total degree kept in the composed dynamics, the rest is an interval remainder (0: all)
+	bool lookahead_inter = false;	// bound also the intermediate steps of the lookahead from the same set
+	double cache_mb = 0;		// memory budget of each control points cache in MB (0: unlimited)
+	string log_file = "";		// file of the log (empty: stderr, verbose logs the bundle of each step)
+	bool monotone = false;		// propagate the corners of box reach sets when the dynamics are certified monotone on them
+	bool refine_intersect = false;	// intersect (instead of unite) the refinements of the parallelotopes of a bundle
+};
+
+#ifndef SAPO_RUNTIME
+struct disturbance_box{			// per-step disturbances d \in [lb,ub]
+	lst deltas;						// variables \in [0,1] such that d = lb + (ub-lb)*delta
+	vector< bool > additive;		// the disturbance enters additively with constant coefficients
+	vector< vector< double > > D;	// coefficients of the additive disturbances (one row per variable)
+	vector< double > lb;			// lower bounds
+	vector< double > ub;			// upper bounds
 };
+#endif
 
 struct poly_values{			// numerical values for polytopes
 	vector<double> base_vertex;
@@ -0,0 +1,72 @@
+/**
+ * @file CompiledModel.h
+ * Precompiled model artifact executed without GiNaC.
+ * The artifact stores the direction and template matrices of the initial
+ * set, the factorization of each template (inverse of its directions, used
+ * by the numerical conversion from constraints to generators), and the
+ * Bernstein control points of each parallelotope/direction pair as compact
+ * polynomials in the base vertex, the lengths and the parameters
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef COMPILEDMODEL_H_
+#define COMPILEDMODEL_H_
+
+#include "Common.h"
+#include "ControlPointCache.h"
+#include "ThreadPool.h"
+#include "DenseMatrix.h"
+
+#include <string>
+
+struct compiled_template{					// parallelotope of the template
+	vector< int > dirs;						// directions of the template
+	vector< vector< double > > Linv;		// inverse of the template directions
+	vector< double > col_norms;				// norms of the columns of Linv
+	vector< int > bound_dirs;				// directions bounded by the parallelotope
+	vector< compact_points > controlPts;	// control points of each bounded direction
+};
+
+class CompiledModel {
+
+private:
+
+	string name;							// name of the model
+	int dim;								// number of variables
+	int num_params;							// number of parameters (0: non-parametric)
+	int mode;								// transformation mode (0=OFO,1=AFO)
+	vector< vector< double > > L;			// direction matrix
+	vector< double > offp;					// upper offsets of the initial set
+	vector< double > offm;					// lower offsets of the initial set
+	vector< vector< double > > paraA;		// parameter set paraA p <= parab (empty if non-parametric)
+	vector< double > parab;
+	vector< compiled_template > templates;	// compiled parallelotopes
+
+	vector< double > const2gen(int i, const vector< double > &offp, const vector< double > &offm);
+	double maxParams(const vector< double > &obj_fun);
+	void canonize(vector< double > &offp, vector< double > &offm);
+
+public:
+
+	CompiledModel(string name, int dim, int num_params, int mode, vector< vector< double > > L, vector< double > offp,
+			vector< double > offm, vector< vector< double > > paraA, vector< double > parab);
+	CompiledModel(string file_name);
+
+	void addTemplate(vector< int > dirs, vector< int > bound_dirs, vector< compact_points > controlPts);
+	void save(string file_name);
+
+	string getName(){ return this->name; };
+	int getDim(){ return this->dim; };
+	int getNumDirs(){ return this->L.size(); };
+
+	void step(vector< double > &offp, vector< double > &offm);	// one reachability step
+	void reach(int k, vector< vector< double > > &offps, vector< vector< double > > &offms);
+	void saveFlowpipe(string file_name, vector< vector< double > > &offps, vector< vector< double > > &offms);
+	vector< double > violations(const vector< vector< double > > &points, vector< vector< double > > &offps, vector< vector< double > > &offms);
+
+	static double lpMax(const vector< vector< double > > &A, const vector< double > &b, const vector< double > &obj_fun);
+};
+
+#endif /* COMPILEDMODEL_H_ */
@@ -0,0 +1,96 @@
+/**
+ * @file ControlPointCache.h
+ * Bounded cache of Bernstein control points.
+ * The control points of a parallelotope/direction (or parallelotope/atom)
+ * pair are polynomials in the base vertex and the lengths of the
+ * parallelotope, and affine in the parameters. They are stored as flat
+ * arrays of coefficients and exponents instead of GiNaC expressions, and the
+ * least recently used entries are evicted when the memory budget is exceeded.
+ * The cache is used by the (single-threaded) preparation stage only: the
+ * numerical stage receives the immutable compact_points of the entries,
+ * which stay valid after their eviction
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef CONTROLPOINTCACHE_H_
+#define CONTROLPOINTCACHE_H_
+
+#include "Common.h"
+#include "MemoryTracker.h"
+
+#include <map>
+#include <list>
+#include <string>
+#include <memory>
+
+struct compact_poly{					// sum_t coeffs[t] * prod_k syms[k]^exps[t*num_syms + k]
+	vector< double > coeffs;			// coefficients of the terms
+	vector< unsigned char > exps;		// exponents of the terms (one row per term)
+};
+
+struct compact_points{					// purely numerical control points (safe to share among threads)
+	int num_syms;						// number of symbols of the polynomials
+	int num_vals;						// symbols with a numerical value (the others are parameters)
+	vector< compact_poly > polys;		// control points
+	bool affine = false;				// polys are the constant term and the coefficients of an affine function over [0,1]^n
+};
+
+#ifndef SAPO_RUNTIME
+struct cache_entry{
+	lst genFun;							// generator function the control points were computed for
+	shared_ptr<const compact_points> controlPts;	// control points
+	long long bytes;					// size of the entry
+	list< vector<int> >::iterator lru;	// position in the LRU list
+};
+#endif
+
+class ControlPointCache {
+
+#ifndef SAPO_RUNTIME	// symbolic path (the runtime only evaluates compiled control points)
+private:
+
+	long long budget;					// memory budget in bytes (<= 0: unlimited)
+	long long bytes;					// bytes currently stored
+	long long peak_bytes;				// maximum of bytes
+	long long hits, misses, evictions;	// statistics
+	long long compositions, shared;		// compositions f[k](genFun) computed for the misses and reused among them
+
+	map< vector<int>, cache_entry > entries;
+	list< vector<int> > lru;			// keys from the most to the least recently used
+
+	void evict();
+
+public:
+
+	ControlPointCache(long long budget);
+
+	bool contains(vector<int> key, lst genFun);
+	void insert(vector<int> key, lst genFun, lst syms, int num_vals, lst controlPts, bool affine = false);
+	shared_ptr<const compact_points> find(vector<int> key);
+	vector< vector< double > > evaluate(vector<int> key, vector< double > values);
+
+	static compact_poly compress(ex e, lst syms, int num_vals);
+
+	int size(){ return this->entries.size(); };
+	long long getBytes(){ return this->bytes; };
+	long long getHits(){ return this->hits; };
+	long long getMisses(){ return this->misses; };
+	long long getEvictions(){ return this->evictions; };
+	void countComposition(bool reused){ this->compositions++; this->shared += reused; };
+	long long getCompositions(){ return this->compositions; };
+	long long getSharedCompositions(){ return this->shared; };
+
+	void report(ostream &out, string name);
+	string toJSON();
+
+	virtual ~ControlPointCache();
+#endif
+
+public:
+
+	static vector< vector< double > > evaluate(const compact_points &controlPts, const vector< double > &values);
+};
+
+#endif /* CONTROLPOINTCACHE_H_ */
@@ -0,0 +1,27 @@
+/**
+ * @file DenseMatrix.h
+ * Numerical kernels on small dense matrices (template and generator
+ * matrices of parallelotopes). It does not depend on GiNaC, so it is shared
+ * by the analysis and the runtime
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef DENSEMATRIX_H_
+#define DENSEMATRIX_H_
+
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+class DenseMatrix {
+
+public:
+
+	static bool invert(vector< vector< double > > M, vector< vector< double > > &inv);	// Gauss-Jordan elimination
+	static vector< double > mult(const vector< vector< double > > &M, const vector< double > &v);
+};
+
+#endif /* DENSEMATRIX_H_ */
@@ -34,6 +34,7 @@ public:
 	void plotRegion();
 	void plotRegionToFile(char *file_name, char color);
 	void plotProjToFile(int var, double time_step, char *file_name, char color);
+	void saveToFile(char *file_name);
 
 	virtual ~Flowpipe();
 };
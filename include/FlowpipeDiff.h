@@ -0,0 +1,62 @@
+/**
+ * @file FlowpipeDiff.h
+ * Compare two flowpipes stored in binary format (see Flowpipe::saveToFile).
+ * Used to check that a new flowpipe contains, or stays close to, a reference one
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef FLOWPIPEDIFF_H_
+#define FLOWPIPEDIFF_H_
+
+#include "Common.h"
+#include "LinearSystem.h"
+
+#include <fstream>
+
+struct flowpipe_diff{				// result of a flowpipe comparison
+	bool shared_dirs;				// true if the flowpipes share the direction matrix
+	bool contained;					// true if the reference is contained in the candidate (and has its length)
+	int steps;						// number of compared steps
+	int ref_steps, cand_steps;		// number of steps of each flowpipe
+	bool truncated;					// a flowpipe ends with an incomplete step
+	int first_violation;			// first step where containment fails (-1: none)
+	double max_violation;			// largest offset violation
+	vector<double> max_width_ratio;	// per direction max of candidate/reference width
+	vector<double> avg_width_ratio;	// per direction mean of candidate/reference width
+};
+
+class FlowpipeDiff {
+
+private:
+
+	ifstream ref;						// reference flowpipe stream
+	ifstream cand;						// candidate flowpipe stream
+	int dim;							// dimension
+	int ref_dirs, cand_dirs;			// number of directions
+	vector< vector< double > > refL;	// reference direction matrix
+	vector< vector< double > > candL;	// candidate direction matrix
+	double tol;							// containment tolerance
+	bool truncated;						// an incomplete step was read
+
+	void readHeader(ifstream &in, char *file_name, int &num_dirs, vector< vector< double > > &L);
+	bool readStep(ifstream &in, int num_dirs, vector<double> &offp, vector<double> &offm);
+	int remainingSteps(ifstream &in, int num_dirs);
+	void checkLengths(flowpipe_diff &diff, bool ref_over, bool cand_over);
+	bool sameDirections();
+
+	flowpipe_diff compareShared();
+	flowpipe_diff compareSupport();
+
+public:
+
+	FlowpipeDiff(char *ref_file, char *cand_file, double tol);
+
+	flowpipe_diff compare();
+	void print(flowpipe_diff diff);
+
+	virtual ~FlowpipeDiff();
+};
+
+#endif /* FLOWPIPEDIFF_H_ */
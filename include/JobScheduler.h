@@ -0,0 +1,69 @@
+/**
+ * @file JobScheduler.h
+ * Run many analyses concurrently on one machine.
+ * The cost of each job is estimated from the model (dimension, degree,
+ * number of directions and templates) and the horizon, or taken from the
+ * history of previous runs. Jobs are started longest first on the free
+ * cores, each one in its own process, as long as their thread quota and
+ * their estimated memory fit the available resources
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef JOBSCHEDULER_H_
+#define JOBSCHEDULER_H_
+
+#include "Common.h"
+#include "Sapo.h"
+#include "Model.h"
+
+#include <map>
+#include <string>
+
+struct sapo_job{
+	string name;			// name of the job (key in the history, no spaces)
+	Model *model;			// model to analyze
+	int steps;				// time horizon (synthesis: 0 for the horizon of the specification)
+	bool synthesis;			// parameter synthesis (otherwise reachability)
+	sapo_opt options;		// options of the analysis
+	int threads;			// thread quota
+	double cost;			// estimated cost (seconds)
+	long mem_kb;			// estimated peak memory (KB)
+};
+
+struct job_record{			// measures of a completed job
+	double time;			// wall-clock time (seconds)
+	long peak_rss_kb;		// peak memory (KB)
+};
+
+class JobScheduler {
+
+private:
+
+	int cores;							// available cores
+	long mem_budget_kb;					// available memory (KB)
+	string history_file;				// file with the measures of the previous runs
+	vector< sapo_job > jobs;			// jobs to run
+	map< string, job_record > history;	// measures of the previous runs
+
+	void loadHistory();
+	void saveHistory();
+	double modelCost(sapo_job &job);
+	int totalDegree(lst vars, lst dyns);
+	int totalDegree(Model *model);
+	long modelMemory(sapo_job &job);
+	void estimate();
+	void execute(sapo_job &job);
+
+public:
+
+	JobScheduler(int cores, long mem_budget_kb, string history_file);
+
+	void add(string name, Model *model, int steps, bool synthesis, sapo_opt options, int threads);
+	double run();
+
+	static long physicalMemory();
+};
+
+#endif /* JOBSCHEDULER_H_ */
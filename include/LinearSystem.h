@@ -12,23 +12,56 @@
 
 #include "Common.h"
 #include <glpk.h>
+#include "PerfCounters.h"
+#include "MemoryTracker.h"
+#include "LowDimPolytope.h"
+#include "ThreadPool.h"
 
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+struct lp_workspace{		// LP problem and index arrays reused by a thread
+	glp_prob *lp;
+	vector<int> ia;
+	vector<int> ja;
+	vector<double> ar;
+
+	lp_workspace(){ lp = NULL; };
+	~lp_workspace(){ if(lp != NULL){ glp_delete_prob(lp); } };
+};
+
+struct constraint_block{		// immutable rows A x <= b shared by many linear systems
+	vector< vector<double> > A;
+	vector< double > b;
+
+	constraint_block(vector< vector<double> > A, vector< double > b){ this->A = A; this->b = b; };
+};
 
 class LinearSystem {
 
 private:
 	int n_vars;					// number of variables
+	int n_rows;					// number of constraints
 	lst vars;					// 	list of variables
 	lst constraints;			//	list of constraints
-	vector< vector<double> > A; // matrix A
-	vector< double > b; 		// vector b
+	vector< shared_ptr<const constraint_block> > blocks;	// constraints of the system
+	vector< vector<double> > A; // matrix A (materialized on demand)
+	vector< double > b; 		// vector b (materialized on demand)
+	atomic<bool> materialized;	// A and b hold the rows of the blocks
+	mutable mutex lazy_lock;	// guards the materialization and the clipped polytope
+	shared_ptr<LowDimPolytope> low_dim;	// clipped polytope (dimension <= 3)
 
 	bool isIn(vector< double > Ai, double bi);	// check if a constraint is already in
+	static bool isIn(const vector< vector<double> > &A, const vector< double > &b, const vector< double > &Ai, double bi);
 	void initLS();								// initialize A and b
-	double solveLinearSystem(vector< vector< double > > A, vector< double > b, vector< double > obj_fun, int min_max);
+	void materialize();							// copy the rows of the blocks in A and b
+	double solveLinearSystem(vector< double > obj_fun, int min_max, bool slack);
 	bool zeroLine(vector<double> line);
+	LowDimPolytope* lowDim();					// clipped polytope (NULL if dimension > 3)
+	double optimize(vector< double > obj_fun, int min_max);
 
 
 public:
@@ -36,6 +69,8 @@ public:
 	LinearSystem();
 	LinearSystem(vector< vector<double> > A, vector< double > b);
 	LinearSystem(lst vars, lst constraints);
+	LinearSystem(const LinearSystem &LS);				// shares the blocks (atomic and mutex are not copied)
+	LinearSystem& operator=(const LinearSystem &LS);
 
 	vector< vector<double> > getA(); 	//return A
 	vector<double> getb(); 				//return b
@@ -48,14 +83,25 @@ public:
 	double maxLinearSystem(vector< double > obj_fun_coeffs);
 	bool isEmpty();						// determine this LS is empty
 
+	// batch queries on points
+	vector<double> violations(const vector< vector<double> > &points);	// max_i A_i x - b_i of each point
+	vector<bool> contains(const vector< vector<double> > &points, double tol);
+	static vector<bool> contains(const vector<double> &viol, double tol);	// points with violation <= tol
+	static void batchViolations(const vector< vector<double> > &A, const vector<double> &ub, const vector<double> &lb,
+			const vector< vector<double> > &points, int first, int last, double *viol);
+
 	// operations on linear system
 	LinearSystem* appendLinearSystem(LinearSystem *LS);
 	vector<bool> redundantCons();
 
-	int dim(){ if(!this->isEmpty()){ return this->A[0].size(); }else{ return 0;}	};
-	int size(){ return this->b.size(); };
+	int dim(){ if(!this->isEmpty()){ return this->n_vars; }else{ return 0;}	};
+	int size(){ return this->n_rows; };
+	int numBlocks(){ return this->blocks.size(); };
 
+	void boundingBox(vector<double> &lb, vector<double> &ub);
 	double volBoundingBox();
+	double volume();
+	vector< vector<double> > vertices();
 
 	void print();
 	void plotRegion();
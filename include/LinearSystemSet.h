@@ -11,6 +11,7 @@
 #define LINEARSYSTEMSET_H_
 
 #include "LinearSystem.h"
+#include "ThreadPool.h"
 
 class LinearSystemSet {
 
@@ -32,6 +33,9 @@ public:
 	LinearSystemSet* unionWith(LinearSystemSet *LSset);
 	LinearSystemSet* boundedUnionWith(LinearSystemSet *LSset, int bound);
 
+	vector<double> violations(const vector< vector<double> > &points);	// minimum violation over the members
+	vector<bool> contains(const vector< vector<double> > &points, double tol);
+
 	double boundingVol();
 	int size();
 	LinearSystem* at(int i);
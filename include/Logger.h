@@ -0,0 +1,80 @@
+/**
+ * @file Logger.h
+ * Leveled, asynchronous logging.
+ * Each thread appends its messages to its own bounded ring buffer and a
+ * background thread drains the buffers (in the order the messages were
+ * logged) to the output, so that diagnostics do not stall the analysis
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef LOGGER_H_
+#define LOGGER_H_
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+using namespace std;
+
+enum log_level {LOG_TRACE,LOG_DEBUG,LOG_INFO,LOG_WARN,LOG_ERROR,LOG_OFF};	// LOG_TRACE: internals of the Bernstein conversion
+
+struct log_entry{
+	unsigned long long seq;		// global order of the message
+	log_level level;			// level of the message
+	string msg;					// message
+};
+
+struct log_buffer{				// ring buffer of a thread
+	mutex lock;
+	condition_variable not_full;
+	vector< log_entry > ring;
+	int head;					// oldest message
+	int count;					// number of messages
+	int pid;					// process that registered the buffer
+};
+
+class Logger {
+
+private:
+
+	static atomic<int> level;						// minimum level logged
+	static atomic<unsigned long long> seq;			// next sequence number
+	static mutex lock;								// guards the registry and the writer
+	static condition_variable wake;					// wakes the writer
+	static vector< shared_ptr<log_buffer> > buffers;	// buffers of all the threads of this process
+	static thread *writer;							// background writer
+	static atomic<int> writer_pid;					// process of the writer
+	static bool stop;								// stop the writer
+	static bool hooked;								// exit and fork handlers installed
+	static ofstream file;							// output file (stderr if not open)
+
+	static const int capacity = 4096;				// messages in each ring buffer
+
+	static void startWriter();
+	static log_buffer* localBuffer();
+	static void drain();
+	static void write();
+	static void shutdown();
+	static void prepareFork();
+	static void parentFork();
+	static void childFork();
+
+public:
+
+	static void setLevel(log_level level);
+	static void setOutput(string file_name);
+	static bool enabled(log_level level){ return level >= Logger::level.load(memory_order_relaxed); };
+
+	static void log(log_level level, const string &msg);
+	static void flush();
+};
+
+#endif /* LOGGER_H_ */
@@ -0,0 +1,54 @@
+/**
+ * @file LowDimPolytope.h
+ * Polytopes of dimension at most 3 clipped to a large box.
+ * The box [-BOX,BOX]^n is clipped with the half-spaces of a linear system:
+ * intervals in 1-D, polygons in 2-D, and lists of polygonal faces in 3-D.
+ * Volume, vertices, and support functions are then computed directly, in
+ * floating point (the support functions rounded outward by the clipping
+ * tolerance). They describe the linear system only when the clipped
+ * polytope is bounded (it does not touch the box), and a negligible volume
+ * does not prove the emptiness (LinearSystem decides it by LP)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef LOWDIMPOLYTOPE_H_
+#define LOWDIMPOLYTOPE_H_
+
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+class LowDimPolytope {
+
+private:
+
+	int dim;										// dimension (1, 2, or 3)
+	vector< vector< vector<double> > > faces;		// 2-D: one polygon, 3-D: polygonal faces
+	vector< vector<double> > vertices;				// vertices of the polytope
+	bool bounded;									// the polytope has vertices, none of them on the initial box
+	bool empty;										// the volume is at most 1e-9 times the one of the bounding box of the vertices
+	double vol;										// volume
+
+	void clip(vector<double> a, double b);
+	vector< vector<double> > clipPolygon(vector< vector<double> > &poly, vector<double> &a, double b, vector< vector<double> > &on_plane);
+	vector< vector<double> > capFace(vector< vector<double> > &points, vector<double> &a);
+	void collectVertices();
+	void computeVolume();
+
+public:
+
+	static const double BOX;						// half width of the initial box
+
+	LowDimPolytope(vector< vector<double> > A, vector<double> b);
+
+	bool isEmpty(){ return this->empty; };
+	bool isBounded(){ return this->bounded; };
+	double volume(){ return this->vol; };
+	vector< vector<double> > getVertices(){ return this->vertices; };
+	double support(vector<double> dir);
+};
+
+#endif /* LOWDIMPOLYTOPE_H_ */
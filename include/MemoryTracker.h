@@ -0,0 +1,77 @@
+/**
+ * @file MemoryTracker.h
+ * Attribute the heap memory to the subsystems of Sapo.
+ * Once enabled, every allocation of the global allocator is charged to the
+ * tag of the innermost MemoryScope of the allocating thread, while the major
+ * containers keep live counters of the objects they hold. Until then the
+ * allocator hooks only tag the blocks as untracked. The hooks are built only
+ * with SAPO_MEMORY_HOOKS, otherwise only the object counters are kept
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef MEMORYTRACKER_H_
+#define MEMORYTRACKER_H_
+
+#include <iostream>
+#include <string>
+#include <atomic>
+
+using namespace std;
+
+enum mem_tag {UNTAGGED,BERNSTEIN_CACHE,FLOWPIPE,LP,SYNTHESIS_SETS,REACH_SETS,NUM_TAGS};
+
+class MemoryTracker {
+
+private:
+
+	static atomic<bool> enabled;						// charge the allocations to the tags
+	static atomic<long long> live[NUM_TAGS];			// bytes currently allocated
+	static atomic<long long> peak[NUM_TAGS];			// maximum of live bytes
+	static atomic<long long> objects[NUM_TAGS];			// objects currently held by the containers
+	static atomic<long long> total_live;				// bytes currently allocated by all tags
+	static atomic<long long> total_peak;				// maximum of total_live
+	static atomic<long long> at_peak[NUM_TAGS];			// live bytes of each tag at the last total peak
+
+	static void updatePeak(atomic<long long> &peak, long long value);
+
+public:
+
+	static void enable(){ enabled = true; };
+	static bool isEnabled(){ return enabled.load(memory_order_relaxed); };
+
+	static mem_tag getTag();
+	static void setTag(mem_tag tag);
+
+	static void allocated(mem_tag tag, long long bytes);
+	static void released(mem_tag tag, long long bytes);
+
+	static void addObjects(mem_tag tag, long long n){ objects[tag] += n; };
+
+	static long long getLive(mem_tag tag){ return live[tag]; };
+	static long long getPeak(mem_tag tag){ return peak[tag]; };
+	static long long peakRSS();
+	static bool hooksBuilt();
+
+	static void report(ostream &out);
+	static string toJSON();
+};
+
+/**
+ * Charge the allocations of the calling thread to a tag
+ * from construction to destruction of the object
+ */
+class MemoryScope {
+
+private:
+
+	mem_tag previous;
+
+public:
+
+	MemoryScope(mem_tag tag);
+	virtual ~MemoryScope();
+};
+
+#endif /* MEMORYTRACKER_H_ */
@@ -21,6 +21,11 @@ protected:
 	lst vars;		// variables
 	lst params;		// parameters
 	lst dyns;		// dynamics
+	vector< lst > modeDyns;		// piecewise dynamics: dynamics of each mode (empty if not piecewise)
+	vector< lst > modeGuards;	// mode m is active where all the polynomials of modeGuards[m] are non-positive
+	lst dists;		// disturbances (new value at each step)
+	vector< double > dist_lb;	// lower bounds of the disturbances
+	vector< double > dist_ub;	// upper bounds of the disturbances
 
 	Bundle *reachSet; // Initial reach set
 	LinearSystemSet *paraSet;
@@ -35,6 +40,12 @@ public:
 	lst getVars(){ return this->vars; }
 	lst getParams(){ return this->params; }
 	lst getDyns(){ return this->dyns; }
+	vector< lst > getModeDyns(){ return this->modeDyns; }
+	vector< lst > getModeGuards(){ return this->modeGuards; }
+	bool isPiecewise(){ return !this->modeDyns.empty(); }
+	lst getDists(){ return this->dists; }
+	vector< double > getDistLB(){ return this->dist_lb; }
+	vector< double > getDistUB(){ return this->dist_ub; }
 
 	Bundle* getReachSet(){ return this->reachSet; }
 	LinearSystemSet* getParaSet(){ return this->paraSet; }
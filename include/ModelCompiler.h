@@ -0,0 +1,34 @@
+/**
+ * @file ModelCompiler.h
+ * Offline compiler of models into artifacts for the GiNaC-free runtime.
+ * The symbolic work of the reachability analysis (generator functions,
+ * compositions and Bernstein expansions) is done once for each
+ * parallelotope/direction pair of the initial set and stored as compact
+ * control points
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef MODELCOMPILER_H_
+#define MODELCOMPILER_H_
+
+#include "Common.h"
+#include "Model.h"
+#include "CompiledModel.h"
+
+class ModelCompiler {
+
+private:
+
+	Model *model;			// model to compile
+	sapo_opt options;		// options of the analysis
+
+public:
+
+	ModelCompiler(Model *model, sapo_opt options);
+
+	CompiledModel* compile();
+};
+
+#endif /* MODELCOMPILER_H_ */
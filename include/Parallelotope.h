@@ -11,6 +11,7 @@
 
 #include "Common.h"
 #include "LinearSystem.h"
+#include "DenseMatrix.h"
 
 class Parallelotope{
 
@@ -26,7 +27,6 @@ private:
 	vector< vector<double> > template_matrix;	// Template matrix
 
 
-	vector<double> hyperplaneThroughPts(vector< vector<double> > pts);	// find hyper plane passing through pts
 	vector<double> lst2vec(ex list);									// convert a lst to a vector of doubles
 	double euclidNorm(vector<double> v);								// compute euclidean norm
 
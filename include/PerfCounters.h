@@ -0,0 +1,85 @@
+/**
+ * @file PerfCounters.h
+ * Per phase and per thread sampling of hardware performance counters
+ * (cycles, instructions, LLC misses, branch misses) through perf_event_open.
+ * When the counters are not available (e.g., in containers or outside Linux)
+ * only the wall-clock time of the phases is recorded
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+
+using namespace std;
+
+enum perf_phase {TRANSFORM_PHASE,BERNSTEIN_PHASE,LP_PHASE,NUM_PHASES};
+
+struct perf_reading{		// counters accumulated by a phase
+	long calls;				// number of times the phase was entered
+	double time;			// wall-clock time (seconds)
+	long long cycles;
+	long long instructions;
+	long long llc_misses;
+	long long branch_misses;
+};
+
+struct perf_thread{				// counters of a thread
+	int id;						// thread index (in order of first sampling)
+	int fd;						// group leader of the counters (-1: unavailable)
+	vector<perf_reading> phases;	// one reading for each phase
+};
+
+class PerfCounters {
+
+private:
+
+	static atomic<bool> enabled;		// sampling switched on (read by the workers)
+	static mutex lock;					// protects the thread registry
+	static vector<perf_thread*> threads;	// counters of all the sampled threads
+
+	static int openCounters();
+	static void printReading(ostream &out, perf_reading r);
+
+public:
+
+	static void enable(bool on){ enabled.store(on,memory_order_relaxed); };
+	static bool isEnabled(){ return enabled.load(memory_order_relaxed); };
+	static bool hardwareAvailable();
+
+	static perf_thread* current();
+	static void read(perf_thread *t, long long values[4]);
+	static void add(perf_thread *t, perf_phase phase, double time, long long start[4], long long end[4]);
+
+	static vector<perf_reading> aggregate();
+	static void reset();
+	static void report(ostream &out);
+	static string toJSON();
+};
+
+/**
+ * Sample a phase from construction to destruction of the object
+ */
+class PerfScope {
+
+private:
+
+	perf_phase phase;
+	perf_thread *thread;
+	double tStart;
+	long long start[4];
+
+public:
+
+	PerfScope(perf_phase phase);
+	virtual ~PerfScope();
+};
+
+#endif /* PERFCOUNTERS_H_ */
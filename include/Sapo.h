@@ -19,6 +19,7 @@
 #include "Bundle.h"
 #include "Model.h"
 #include "Flowpipe.h"
+#include "Logger.h"
 
 class Sapo {
 
@@ -26,13 +27,42 @@ private:
 	lst dyns;			// dynamics of the system
 	lst vars;			// variables of the system
 	lst params;			// parameters of the system
+	lst synth_dyns;		// dynamics with all the disturbances (used by the synthesis)
+	disturbance_box *dists;	// per-step disturbances (NULL if none)
 	sapo_opt options;	// options
-	map< vector<int>,pair<lst,lst> > reachControlPts;		// symbolic control points
-	map< vector<int>,pair<lst,lst> > synthControlPts;		// symbolic control points
+	ControlPointCache *reachControlPts;		// control points of the reachability
+	ControlPointCache *synthControlPts;		// control points of the synthesis
+	vector< lst > lookaheadDyns;						// f^j truncated to options.lookahead_degree (j = 1,...,options.lookahead)
+	vector< vector< compact_poly > > lookaheadRems;		// terms of f^j removed by the truncation (in the variables and the parameters)
+	vector< ControlPointCache* > lookaheadControlPts;	// control points of f^j (non-parametric, then parametric)
+	lst lookaheadDeltas;								// variables of the remainders
+	vector< compact_points > monotoneDyns;				// dynamics in numerical form (corner propagation)
+	vector< vector< compact_points > > monotoneJac;		// Bernstein coefficients of df_i/dx_j over a box, in its lower corner and widths
+	int monotone_steps;									// steps computed by corner propagation
+	long long refine_calls, refine_in, refine_out;		// refinements and their input and output parameter sets
+	vector< lst > modeDyns;								// piecewise dynamics: dynamics of each mode (empty if not piecewise)
+	vector< lst > modeGuards;							// guards of each mode
+	vector< ControlPointCache* > modeControlPts;		// control points of each mode (non-parametric, then parametric)
+	ControlPointCache *guardControlPts;					// control points of the guards
+	long long piecewise_steps, active_modes;			// piecewise transformations and modes bounded by them
+	ofstream metrics;									// per-step memory metrics of all the reach calls (options.mem_metrics)
 
+	void initDisturbances(Model *model);					// split additive and nonlinear disturbances
 	vector<Bundle*> reachWitDec(Bundle* initSet, int k);	// reachability with template decomposition
+	void initLookahead();									// compose the dynamics
+	void intervalBound(const compact_poly &e, vector<double> &lb, vector<double> &ub, double &lo, double &hi);
+	vector< Bundle* > lookaheadTransform(Bundle *X, LinearSystem *paraSet, int h);	// bound f^h at once
+	bool boxBounds(Bundle *X, vector<double> &lo, vector<double> &hi);		// bounds of a bundle with axis-aligned directions
+	void initMonotone();									// compile the Jacobian for the monotonicity certificates
+	Bundle* monotoneTransform(Bundle *X);					// corner propagation (NULL if not certified)
+	void initPiecewise(Model *model);						// check the modes and allocate their caches
+	Bundle* piecewiseTransform(Bundle *X, LinearSystem *paraSet);	// bound the active modes only
+	void writeMetrics(int step);							// append the memory of a reach step to the metrics
 	LinearSystemSet* synthesizeSTL(Bundle *reachSet, LinearSystemSet *parameterSet, STL *formula);
 	LinearSystemSet* refineParameters(Bundle *reachSet, LinearSystemSet *parameterSet, STL *sigma);
+	bool affineRow(ex e, vector<double> &row);	// coefficients of an affine function of the parameters
+	int quickCheck(const vector< vector< double > > &controlPts, const vector< double > &vertex_row,
+			const vector<double> &lb, const vector<double> &ub);		// decide an atom without LPs
 	LinearSystemSet* synthesizeUntil(Bundle *reachSet, LinearSystemSet *parameterSet, STL *sigma);
 	LinearSystemSet* synthesizeAlways(Bundle *reachSet, LinearSystemSet *parameterSet, STL *formula);
 
@@ -43,6 +73,8 @@ public:
 	Flowpipe* reach(Bundle* initSet, LinearSystem* paraSet, int k);								// parameteric reachability
 	LinearSystemSet* synthesize(Bundle *reachSet, LinearSystemSet *parameterSet, STL *formula);	// parameter synthesis
 
+	int getMonotoneSteps(){ return this->monotone_steps; };		// steps computed by corner propagation
+
 
 
 	virtual ~Sapo();
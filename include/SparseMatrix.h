@@ -0,0 +1,48 @@
+/**
+ * @file SparseMatrix.h
+ * Matrix stored in compressed sparse row (CSR) form.
+ * Used for direction matrices whose rows are mostly axis-aligned
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef SPARSEMATRIX_H_
+#define SPARSEMATRIX_H_
+
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+class SparseMatrix {
+
+private:
+
+	int num_cols;					// number of columns
+	vector< int > row_ptr;			// row i is stored in [row_ptr[i],row_ptr[i+1])
+	vector< int > cols;				// column of each non-zero element
+	vector< double > vals;			// value of each non-zero element
+
+public:
+
+	SparseMatrix();
+	SparseMatrix(vector< vector< double > > M);
+
+	int numRows(){ return this->row_ptr.size() - 1; };
+	int numCols(){ return this->num_cols; };
+	int nnz(){ return this->vals.size(); };
+
+	// non-zero elements of row i are at positions [rowBegin(i),rowEnd(i))
+	int rowBegin(int i){ return this->row_ptr[i]; };
+	int rowEnd(int i){ return this->row_ptr[i+1]; };
+	int col(int p){ return this->cols[p]; };
+	double val(int p){ return this->vals[p]; };
+
+	double dot(int i, const vector< double > &x);	// row i times a dense vector
+	double dot(int i, int j);						// row i times row j
+	double norm(int i);								// euclidean norm of row i
+	double orthProx(int i, int j);					// |angle(M[i],M[j]) - pi/2|
+};
+
+#endif /* SPARSEMATRIX_H_ */
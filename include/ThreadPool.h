@@ -0,0 +1,61 @@
+/**
+ * @file ThreadPool.h
+ * Pool of worker threads shared by the numerical kernels of Sapo.
+ * Only purely numerical work (e.g., LPs) must be submitted to the pool:
+ * GiNaC expressions are not thread-safe, so no ex or lst may be captured by
+ * a job (the symbolic work is done beforehand by the preparation stages)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "MemoryTracker.h"
+
+using namespace std;
+
+class ThreadPool {
+
+private:
+
+	vector<thread> workers;				// worker threads
+	mutex lock;							// protects the job
+	condition_variable job_ready;		// signals a new job to the workers
+	condition_variable job_done;		// signals the completion of a job
+
+	function<void(int)> body;			// body of the actual job
+	int num_iters;						// iterations of the actual job
+	int next_iter;						// next iteration to assign
+	int running;						// workers still on the actual job
+	long job_id;						// id of the actual job
+	mem_tag tag;						// memory tag of the submitting thread
+	bool stop;							// terminate the workers
+
+	static ThreadPool *pool;			// shared pool
+	static mutex pool_lock;				// protects the shared pool
+
+	ThreadPool(int num_threads);
+	void work();
+	void runIterations();
+
+public:
+
+	static void setThreads(int num_threads);
+	static ThreadPool* shared();
+	static void stopShared();			// join the workers of the shared pool (before a fork)
+
+	int size(){ return this->workers.size() + 1; };
+	void parallelFor(int n, function<void(int)> body);
+
+	virtual ~ThreadPool();
+};
+
+#endif /* THREADPOOL_H_ */
@@ -0,0 +1,53 @@
+/**
+ * @file Zonotope.h
+ * Represent and manipulate a zonotope q + sum_i alpha_i g_i with alpha in [0,1]^m
+ * and m >= dim generators. Zonotopes are bundle members that, unlike
+ * parallelotopes, can be tightened by adding single generators
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef ZONOTOPE_H_
+#define ZONOTOPE_H_
+
+#include "Common.h"
+#include "ControlPointCache.h"
+#include "Parallelotope.h"
+#include "SparseMatrix.h"
+
+#include <sstream>
+
+class Zonotope {
+
+private:
+
+	int dim;								// dimension of the zonotope
+	int max_gens;							// maximum number of generators kept by the order reduction
+	vector< double > q;						// base point
+	vector< vector< double > > G;			// generators (one for each row)
+	lst alpha;								// free variables \in [0,1] (one for each generator)
+
+	double prod(vector<double> v1, vector<double> v2);
+	static void centeredBound(const compact_poly &p, double &lo, double &hi);	// interval of p over [-1/2,1/2]^n
+
+public:
+
+	Zonotope(vector< double > q, vector< vector< double > > G, int max_gens);
+	Zonotope(Parallelotope *P, int max_gens);
+
+	int getDim(){ return this->dim; };
+	int getNumGens(){ return this->G.size(); };
+	int getMaxGens(){ return this->max_gens; };
+	vector< double > getBasePoint(){ return this->q; };
+	vector< vector< double > > getGenerators(){ return this->G; };
+	lst getAlpha(){ return this->alpha; };
+	lst getGeneratorFunction();
+
+	double support(vector<double> l);		// max of l*x over the zonotope
+	double support(SparseMatrix *M, int i, double sign);	// max of sign*M[i]*x over the zonotope
+	Zonotope* reduceOrder();				// Girard's order reduction
+	Zonotope* transform(lst vars, lst f, disturbance_box *dists);	// over-approximation of f(Z)
+};
+
+#endif /* ZONOTOPE_H_ */
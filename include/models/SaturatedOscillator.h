@@ -0,0 +1,22 @@
+/**
+ * @file SaturatedOscillator.h
+ * Oscillator with saturated velocity feedback (piecewise dynamics)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef SATURATEDOSCILLATOR_H_
+#define SATURATEDOSCILLATOR_H_
+
+#include "Model.h"
+
+class SaturatedOscillator : public Model {
+
+private:
+
+public:
+	SaturatedOscillator();
+};
+
+#endif /* SATURATEDOSCILLATOR_H_ */
@@ -0,0 +1,45 @@
+/**
+ * @file Synthetic.h
+ * Synthetic polynomial model of configurable size
+ * Used to stress-test Sapo along dimension, degree, sparsity, coupling,
+ * number of directions, number of templates, and number of parameters
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef SYNTHETIC_H_
+#define SYNTHETIC_H_
+
+#include "Model.h"
+#include "Atom.h"
+#include "Always.h"
+
+enum coupling_type {CHAIN,RING,STAR,RANDOM};
+
+struct synthetic_opt{
+	int dim;				// number of variables
+	int degree;				// maximum degree of the monomials
+	int terms;				// number of nonlinear monomials per variable (sparsity)
+	coupling_type coupling;	// which variables appear in the monomials of each variable
+	int num_dirs;			// number of bundle directions (>= dim)
+	int num_temps;			// number of parallelotopes
+	int num_params;			// number of parameters
+	unsigned int seed;		// seed of the random coefficients
+};
+
+class Synthetic : public Model {
+
+private:
+
+	synthetic_opt opt;
+
+	vector<int> coupledVars(int i);
+
+public:
+	Synthetic(synthetic_opt opt);
+
+	synthetic_opt getOptions(){ return this->opt; }
+};
+
+#endif /* SYNTHETIC_H_ */
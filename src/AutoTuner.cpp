@@ -0,0 +1,249 @@
+/**
+ * @file AutoTuner.cpp
+ * Probes of the candidate configurations and the per-model profiles
+ * (one "key value" line per tuned option)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "AutoTuner.h"
+
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+
+/**
+ * Constructor that instantiates the tuner
+ *
+ * @param[in] model model to tune
+ * @param[in] base options not touched by the tuner
+ * @param[in] probe_steps horizon of the probe runs
+ * @param[in] objective FASTEST or MOST_PRECISE
+ * @param[in] target maximum growth per step (FASTEST) or maximum seconds per step (MOST_PRECISE)
+ */
+AutoTuner::AutoTuner(Model *model, sapo_opt base, int probe_steps, tune_objective objective, double target){
+	this->model = model;
+	this->base = base;
+	this->probe_steps = max(1,probe_steps);
+	this->objective = objective;
+	this->target = target;
+}
+
+/**
+ * Candidate configurations: both transformations, without decomposition and
+ * with a few decomposition budgets and weights (the threads are tuned last)
+ *
+ * @returns candidate options
+ */
+vector< sapo_opt > AutoTuner::candidates(){
+
+	int decomps[] = {1,3};
+	double alphas[] = {0.25,0.5,0.75};
+
+	vector< sapo_opt > cands;
+	for(int trans=0; trans<2; trans++){
+		sapo_opt options = this->base;
+		options.trans = trans;
+		options.decomp = 0;
+		options.alpha = 0.5;
+		options.threads = 1;
+		cands.push_back(options);
+		for(int i=0; i<2; i++){
+			for(int j=0; j<3; j++){
+				options.decomp = decomps[i];
+				options.alpha = alphas[j];
+				cands.push_back(options);
+			}
+		}
+	}
+	return cands;
+}
+
+/**
+ * Average width of a bundle along its directions
+ *
+ * @param[in] B bundle
+ * @returns average of (offp + offm)/||L_i||
+ */
+double AutoTuner::width(Bundle *B){
+
+	vector< vector< double > > L = B->getDirections();
+	double w = 0;
+	for(int i=0; i<B->getSize(); i++){
+		double norm = 0;
+		for(int j=0; j<(signed)L[i].size(); j++){
+			norm += L[i][j]*L[i][j];
+		}
+		w += (B->getOffp(i) + B->getOffm(i))/sqrt(norm);
+	}
+	return w/B->getSize();
+}
+
+/**
+ * Run the model on the probe horizon
+ *
+ * @param[in] options configuration to probe
+ * @returns time per step and growth of the widths per step
+ */
+tune_probe AutoTuner::probe(sapo_opt options){
+
+	ostringstream null_out;			// keep the output of the tuner readable
+	streambuf *cout_buf = cout.rdbuf(null_out.rdbuf());
+
+	Sapo *sapo = new Sapo(this->model,options);
+	chrono::steady_clock::time_point tStart = chrono::steady_clock::now();
+	Flowpipe *flowpipe;
+	if( this->model->getParams().nops() > 0 ){
+		flowpipe = sapo->reach(this->model->getReachSet(),this->model->getParaSet()->at(0),this->probe_steps);
+	}else{
+		flowpipe = sapo->reach(this->model->getReachSet(),this->probe_steps);
+	}
+	double time = chrono::duration<double>(chrono::steady_clock::now() - tStart).count();
+
+	cout.rdbuf(cout_buf);
+
+	tune_probe p;
+	p.options = options;
+	p.time_per_step = time/this->probe_steps;
+
+	double w0 = this->width(flowpipe->get(0));
+	double wk = this->width(flowpipe->get(flowpipe->size()-1));
+	if( w0 > 0 ){
+		p.growth = pow(wk/w0,1.0/this->probe_steps);
+	}else{
+		p.growth = wk;
+	}
+	if( !(p.growth == p.growth) ){	// diverging bundle
+		p.growth = HUGE_VAL;
+	}
+
+	for(int i=0; i<flowpipe->size(); i++){		// the probe bundles, but not the initial set of the model
+		if( flowpipe->get(i) != this->model->getReachSet() ){
+			delete flowpipe->get(i);
+		}
+	}
+	delete flowpipe;
+	delete sapo;
+	return p;
+}
+
+/**
+ * Compare two probes w.r.t. the objective. A probe meeting the target beats
+ * one that does not, two probes meeting the target are compared on the
+ * objective, and two probes missing the target on the target itself
+ *
+ * @param[in] p1 first probe
+ * @param[in] p2 second probe
+ * @returns true if p1 is better than p2
+ */
+bool AutoTuner::better(tune_probe &p1, tune_probe &p2){
+
+	double goal1, goal2, cons1, cons2;
+	if( this->objective == FASTEST ){
+		goal1 = p1.time_per_step; goal2 = p2.time_per_step;
+		cons1 = p1.growth; cons2 = p2.growth;
+	}else{
+		goal1 = p1.growth; goal2 = p2.growth;
+		cons1 = p1.time_per_step; cons2 = p2.time_per_step;
+	}
+
+	bool ok1 = cons1 <= this->target;
+	bool ok2 = cons2 <= this->target;
+	if( ok1 != ok2 ){
+		return ok1;
+	}
+	if( ok1 ){
+		return goal1 < goal2;
+	}
+	return cons1 < cons2;
+}
+
+/**
+ * Probe the candidates and pick the best one, then try the best one with
+ * one thread per core
+ *
+ * @returns tuned options
+ */
+sapo_opt AutoTuner::tune(){
+
+	vector< sapo_opt > cands = this->candidates();
+
+	tune_probe best;
+	for(int i=0; i<(signed)cands.size(); i++){
+		tune_probe p = this->probe(cands[i]);
+		cout<<"  trans="<<p.options.trans<<" decomp="<<p.options.decomp<<" alpha="<<p.options.alpha;
+		cout<<"\ttime/step: "<<p.time_per_step<<" s, growth/step: "<<p.growth<<"\n";
+		if( i == 0 || this->better(p,best) ){
+			best = p;
+		}
+	}
+
+	int cores = thread::hardware_concurrency();
+	if( cores > 1 ){
+		sapo_opt options = best.options;
+		options.threads = cores;
+		tune_probe p = this->probe(options);
+		cout<<"  threads="<<cores<<"\ttime/step: "<<p.time_per_step<<" s\n";
+		if( p.time_per_step < best.time_per_step ){
+			best.options.threads = cores;
+		}
+	}
+
+	ThreadPool::setThreads(this->base.threads);
+	return best.options;
+}
+
+/**
+ * Store the tuned options ("key value" lines)
+ *
+ * @param[in] file_name profile file
+ * @param[in] options tuned options
+ */
+void AutoTuner::saveProfile(string file_name, sapo_opt options){
+
+	ofstream out(file_name.c_str());
+	if( !out.is_open() ){
+		cout<<"AutoTuner::saveProfile : cannot open "<<file_name;
+		exit (EXIT_FAILURE);
+	}
+	out<<"trans "<<options.trans<<"\n";
+	out<<"decomp "<<options.decomp<<"\n";
+	out<<"alpha "<<options.alpha<<"\n";
+	out<<"threads "<<options.threads<<"\n";
+	out.close();
+}
+
+/**
+ * Load the tuned options, if the profile exists
+ *
+ * @param[in] file_name profile file
+ * @param[out] options options updated with the profile
+ * @returns true if the profile was loaded
+ */
+bool AutoTuner::loadProfile(string file_name, sapo_opt &options){
+
+	ifstream in(file_name.c_str());
+	if( !in.is_open() ){
+		return false;
+	}
+
+	string key;
+	double value;
+	while( in>>key>>value ){
+		if( key == "trans" ){
+			options.trans = (int)value;
+		}else if( key == "decomp" ){
+			options.decomp = (int)value;
+		}else if( key == "alpha" ){
+			options.alpha = value;
+		}else if( key == "threads" ){
+			options.threads = (int)value;
+		}else{
+			cout<<"AutoTuner::loadProfile : unknown option "<<key;
+			exit (EXIT_FAILURE);
+		}
+	}
+	return true;
+}
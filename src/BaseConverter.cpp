@@ -8,6 +8,8 @@
 
 #include "BaseConverter.h"
 
+#include <sstream>
+
 /**
  * Constructor that instantiates the base converter
  *
@@ -261,6 +263,7 @@ ex BaseConverter::bernCoeff(vector<int> mi){
  */
 lst BaseConverter::getBernCoeffs(){
 
+	PerfScope perf(BERNSTEIN_PHASE);
 	//cout<<"\tComputing Bernstein coefficients...\n";
 
 	lst bern_coeffs;
@@ -282,11 +285,12 @@ lst BaseConverter::getRationalBernCoeffs(){
 
 	lst bern_coeffs;
 
-	cout<<"Degrees: ";
+	ostringstream msg;
+	msg<<"BaseConverter::getRationalBernCoeffs : degrees ";
 	vector<int> degs;
 	for(int i=0; i<(signed)this->vars.nops();i++){
 		degs.push_back(max(this->num.degree(this->vars[i]),this->denom.degree(this->vars[i])));
-		cout<<degs[i]<<", ";
+		msg<<degs[i]<<", ";
 	}
 
 	BaseConverter *num_conv = new BaseConverter(this->vars,this->num,degs);
@@ -303,7 +307,10 @@ lst BaseConverter::getRationalBernCoeffs(){
 
 	// eliminate duplicates
 	bern_coeffs.unique();
-	cout<<"(Total points:"<<bern_coeffs.nops()<<")\n";
+	if(Logger::enabled(LOG_TRACE)){
+		msg<<"(total points: "<<bern_coeffs.nops()<<")";
+		Logger::log(LOG_TRACE,msg.str());
+	}
 	return bern_coeffs;
 
 }
@@ -357,7 +364,11 @@ void BaseConverter::split(int direction, double split_point){
 
 			for(int j=0; j<this->degrees.size(); j++){
 
-				cout<<"j:"<<j<<" dir: "<<direction<<"\n"<<" dir: "<<direction<<"\n";
+				if(Logger::enabled(LOG_TRACE)){
+					ostringstream msg;
+					msg<<"BaseConverter::split : j: "<<j<<" dir: "<<direction;
+					Logger::log(LOG_TRACE,msg.str());
+				}
 
 				if( j!= direction ){
 
@@ -377,7 +388,11 @@ void BaseConverter::split(int direction, double split_point){
 		}
 	}
 
-	cout<<"\n"<<B<<"\n";
+	if(Logger::enabled(LOG_TRACE)){
+		ostringstream msg;
+		msg<<"BaseConverter::split : "<<B;
+		Logger::log(LOG_TRACE,msg.str());
+	}
 
 }
 
@@ -388,6 +403,7 @@ void BaseConverter::split(int direction, double split_point){
  */
 lst BaseConverter::getBernCoeffsMatrix(){
 
+	PerfScope perf(BERNSTEIN_PHASE);
 	//cout<<"\tComputing Bernstein coefficients...\n";
 
 	// degrees increased by one
@@ -0,0 +1,159 @@
+/**
+ * @file Benchmark.cpp
+ * Sweeps of the synthetic models: each run is executed in a forked process
+ * and appends one JSON record to the benchmark file
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Benchmark.h"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/**
+ * Constructor that instantiates the benchmark suite
+ *
+ * @param[in] options options of the analyses
+ * @param[in] base model varied along each axis
+ * @param[in] steps reachability steps of each run
+ * @param[in] file_name file where the JSON records are appended (one per line)
+ */
+Benchmark::Benchmark(sapo_opt options, synthetic_opt base, int steps, string file_name){
+	this->options = options;
+	this->base = base;
+	this->steps = steps;
+	this->file_name = file_name;
+}
+
+/**
+ * Run the base model varying one axis
+ *
+ * @param[in] axis name of the axis (dim, degree, terms, coupling, dirs, temps, params, lookahead)
+ * @param[in] values values of the axis
+ */
+void Benchmark::sweep(string axis, vector<int> values){
+
+	for(int i=0; i<(signed)values.size(); i++){
+
+		synthetic_opt opt = this->base;
+		sapo_opt options = this->options;
+		int extra_dirs = opt.num_dirs - opt.dim;
+
+		if( axis == "dim" ){
+			opt.dim = values[i];
+			opt.num_dirs = values[i] + extra_dirs;
+		}else if( axis == "degree" ){
+			opt.degree = values[i];
+		}else if( axis == "terms" ){
+			opt.terms = values[i];
+		}else if( axis == "coupling" ){
+			opt.coupling = (coupling_type)values[i];
+		}else if( axis == "dirs" ){
+			opt.num_dirs = opt.dim + values[i];
+		}else if( axis == "temps" ){
+			opt.num_temps = values[i];
+			opt.num_dirs = max(opt.num_dirs,opt.dim + values[i] - 1);
+		}else if( axis == "params" ){
+			opt.num_params = values[i];
+		}else if( axis == "lookahead" ){
+			options.lookahead = values[i];
+		}else{
+			cout<<"Benchmark::sweep : unknown axis "<<axis;
+			exit (EXIT_FAILURE);
+		}
+
+		this->run(axis,values[i],opt,options);
+	}
+}
+
+/**
+ * Run the default sweeps along all the axes
+ */
+void Benchmark::sweepAll(){
+
+	int dims[] = {2,4,8,16,32};
+	int degrees[] = {1,2,3,4};
+	int terms[] = {1,2,4,8};
+	int couplings[] = {CHAIN,RING,STAR,RANDOM};
+	int dirs[] = {0,2,4,8};
+	int temps[] = {1,2,3,5};
+	int params[] = {0,1,2,4};
+	int lookaheads[] = {1,2,3};
+
+	this->sweep("dim",vector<int>(dims,dims+5));
+	this->sweep("degree",vector<int>(degrees,degrees+4));
+	this->sweep("terms",vector<int>(terms,terms+4));
+	this->sweep("coupling",vector<int>(couplings,couplings+4));
+	this->sweep("dirs",vector<int>(dirs,dirs+4));
+	this->sweep("temps",vector<int>(temps,temps+4));
+	this->sweep("params",vector<int>(params,params+4));
+	this->sweep("lookahead",vector<int>(lookaheads,lookaheads+3));
+}
+
+/**
+ * Run a single analysis in a child process (so that its peak memory is its own)
+ * and append its record to the benchmark file
+ *
+ * @param[in] axis name of the varied axis
+ * @param[in] value value of the varied axis
+ * @param[in] opt synthetic model to analyze
+ * @param[in] options options of the analysis
+ */
+void Benchmark::run(string axis, int value, synthetic_opt opt, sapo_opt options){
+
+	cout<<"Benchmark "<<axis<<"="<<value<<"\t";
+	cout.flush();
+
+	ThreadPool::stopShared();	// the child starts its own pool
+	pid_t pid = fork();
+	if( pid < 0 ){
+		cout<<"Benchmark::run : cannot fork";
+		exit (EXIT_FAILURE);
+	}
+
+	if( pid == 0 ){
+
+		Synthetic *model = new Synthetic(opt);
+		opt = model->getOptions();
+		options.perf_counters = true;
+		MemoryTracker::enable();	// the record reports the memory of each subsystem
+		Sapo *sapo = new Sapo(model,options);
+
+		clock_t tStart = clock();
+		if( opt.num_params > 0 ){
+			sapo->reach(model->getReachSet(),model->getParaSet()->at(0),this->steps);
+		}else{
+			sapo->reach(model->getReachSet(),this->steps);
+		}
+		double time = double(clock() - tStart) / CLOCKS_PER_SEC;
+
+		long long peak_rss = MemoryTracker::peakRSS();
+
+		ostringstream record;
+		record<<"{\"axis\":\""<<axis<<"\",\"value\":"<<value;
+		record<<",\"dim\":"<<opt.dim<<",\"degree\":"<<opt.degree<<",\"terms\":"<<opt.terms;
+		record<<",\"coupling\":"<<opt.coupling<<",\"num_dirs\":"<<opt.num_dirs;
+		record<<",\"num_temps\":"<<opt.num_temps<<",\"num_params\":"<<opt.num_params;
+		record<<",\"steps\":"<<this->steps<<",\"trans\":"<<options.trans<<",\"lookahead\":"<<options.lookahead;
+		record<<",\"time\":"<<time<<",\"peak_rss_kb\":"<<peak_rss;
+		record<<",\"perf\":"<<PerfCounters::toJSON();
+		record<<",\"memory\":"<<MemoryTracker::toJSON()<<"}\n";
+
+		ofstream out;
+		out.open(this->file_name.c_str(), ios_base::app);
+		out<<record.str();
+		out.close();
+
+		exit(EXIT_SUCCESS);
+	}
+
+	int status;
+	waitpid(pid,&status,0);
+	if( !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS ){
+		cout<<"Benchmark::run : run "<<axis<<"="<<value<<" failed\n";
+	}
+}
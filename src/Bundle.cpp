@@ -9,6 +9,7 @@
 
 #include "Bundle.h"
 #include <string>
+#include <sstream>
 
 
 /**
@@ -49,6 +50,7 @@ Bundle::Bundle(vector<lst> vars, vector< vector< double > > L, vector< double >
 
 	this->vars = vars;
 	this->L = L;
+	this->Ls = SparseMatrix(L);
 	this->offp = offp;
 	this->offm = offm;
 	this->T = T;
@@ -61,9 +63,9 @@ Bundle::Bundle(vector<lst> vars, vector< vector< double > > L, vector< double >
 		}
 	}
 	for(int i=0; i<this->getNumDirs(); i++){
-		this->Theta[i][i] = 0;
+		this->Theta[i][i] = this->orthProx(i,i);	// a repeated direction is the least orthogonal
 		for(int j=i+1; j<this->getNumDirs(); j++){
-			double prox = this->orthProx(this->L[i],this->L[j]);
+			double prox = this->orthProx(i,j);
 			this->Theta[i][j] = prox;
 			this->Theta[j][i] = prox;
 		}
@@ -120,6 +122,7 @@ Bundle::Bundle(vector< vector< double > > L, vector< double > offp, vector< doub
 
 	this->vars = paraVars;
 	this->L = L;
+	this->Ls = SparseMatrix(L);
 	this->offp = offp;
 	this->offm = offm;
 	this->T = T;
@@ -132,15 +135,92 @@ Bundle::Bundle(vector< vector< double > > L, vector< double > offp, vector< doub
 		}
 	}
 	for(int i=0; i<this->getNumDirs(); i++){
-		this->Theta[i][i] = 0;
+		this->Theta[i][i] = this->orthProx(i,i);	// a repeated direction is the least orthogonal
 		for(int j=i+1; j<this->getNumDirs(); j++){
-			double prox = this->orthProx(this->L[i],this->L[j]);
+			double prox = this->orthProx(i,j);
 			this->Theta[i][j] = prox;
 			this->Theta[j][i] = prox;
 		}
 	}
 }
 
+/**
+ * Compact one-line dump of the bundle: offsets, and optionally directions
+ * and templates (they change only with the decompositions)
+ *
+ * @param[in] with_dirs dump the directions and the templates
+ * @returns string "[L: l_1; ...] [T: t_1; ...] offp: ... offm: ..."
+ */
+string Bundle::toCompact(bool with_dirs){
+
+	ostringstream out;
+	out.precision(10);
+	if( with_dirs ){
+		out<<"L:";
+		for(int i=0; i<this->getSize(); i++){
+			for(int j=0; j<this->dim; j++){
+				out<<" "<<this->L[i][j];
+			}
+			out<<";";
+		}
+		out<<" T:";
+		for(int i=0; i<this->getCard(); i++){
+			for(int j=0; j<(signed)this->T[i].size(); j++){
+				out<<" "<<this->T[i][j];
+			}
+			out<<";";
+		}
+		out<<" ";
+	}
+	out<<"offp:";
+	for(int i=0; i<this->getSize(); i++){
+		out<<" "<<this->offp[i];
+	}
+	out<<" offm:";
+	for(int i=0; i<this->getSize(); i++){
+		out<<" "<<this->offm[i];
+	}
+	return out.str();
+}
+
+/**
+ * Signed violation of many points: max_i max(L_i x - offp_i, -L_i x - offm_i)
+ * (non-positive inside the bundle)
+ *
+ * @param[in] points points to test
+ * @returns maximum violation of each point
+ */
+vector<double> Bundle::violations(const vector< vector<double> > &points){
+
+	const int chunk = 4096;
+	int n = points.size();
+	vector<double> viol (n,-HUGE_VAL);
+	vector<double> lb = this->negate(this->offm);
+
+	for(int p=0; p<n; p++){
+		if( (signed)points[p].size() != this->dim ){
+			cout<<"Bundle::violations : the points must have "<<this->dim<<" coordinates";
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	ThreadPool::shared()->parallelFor((n + chunk - 1)/chunk,[&](int c){
+		LinearSystem::batchViolations(this->L,this->offp,lb,points,c*chunk,min(n,(c+1)*chunk),&viol[0]);
+	});
+	return viol;
+}
+
+/**
+ * Membership of many points
+ *
+ * @param[in] points points to test
+ * @param[in] tol tolerance on the violations
+ * @returns true for the points in the bundle (up to tol)
+ */
+vector<bool> Bundle::contains(const vector< vector<double> > &points, double tol){
+	return LinearSystem::contains(this->violations(points),tol);
+}
+
 /**
  * Generate the polytope represented by the bundle
  *
@@ -211,7 +291,9 @@ Bundle* Bundle::canonize(){
 		canoffp.push_back(bund->maxLinearSystem(this->L[i]));
 		canoffm.push_back(bund->maxLinearSystem(this->negate(this->L[i])));
 	}
-	return new Bundle(this->vars,this->L,canoffp,canoffm,this->T);
+	Bundle *res = new Bundle(this->vars,this->L,canoffp,canoffm,this->T);
+	res->setZonotopes(this->zonotopes);
+	return res;
 }
 
 /**
@@ -276,23 +358,32 @@ Bundle* Bundle::decompose(double alpha, int max_iters){
 		i++;
 	}
 
-	return new Bundle(this->vars,this->L,this->offp,this->offp,bestT);
+	Bundle *res = new Bundle(this->vars,this->L,this->offp,this->offp,bestT);
+	res->setZonotopes(this->zonotopes);
+	return res;
 
 }
 
 /**
- * Transform the bundle
+ * Preparation stage of the transformations. All the symbolic work (generator
+ * functions, compositions and Bernstein expansions of the cache misses) is
+ * done here, on the calling thread, and it results in purely numerical jobs
+ * that the numerical stage can bound in parallel
  *
  * @param[in] vars variables appearing in the transforming function
+ * @param[in] params parameters appearing in the transforming function (empty if none)
  * @param[in] f transforming function
- * @param[in,out] controlPts control points computed so far that might be updated
+ * @param[in,out] controlPts cache of the control points computed so far that might be updated
  * @param[in] mode transformation mode (0=OFO,1=AFO)
- * @returns transformed bundle
+ * @param[in] dists per-step disturbances (NULL if none)
+ * @param[out] values base vertex and lengths of each parallelotope
+ * @returns one job for each parallelotope/direction pair
  */
-Bundle* Bundle::transform(lst vars, lst f, map< vector<int>,pair<lst,lst> > &controlPts, int mode){
+vector< bound_job > Bundle::prepareTransform(lst vars, lst params, lst f, ControlPointCache *controlPts, int mode,
+		disturbance_box *dists, vector< vector< double > > &values){
 
-	vector<double> newDp (this->getSize(),DBL_MAX);
-	vector<double> newDm (this->getSize(),DBL_MAX);
+	vector< bound_job > jobs;
+	values.clear();
 
 	vector<int> dirs_to_bound;
 	if(mode){	// dynamic transformation
@@ -301,21 +392,17 @@ Bundle* Bundle::transform(lst vars, lst f, map< vector<int>,pair<lst,lst> > &con
 		}
 	}
 
-	for(int i=0; i<this->getCard(); i++){	// for each parallelotope
+	map< int, vector< pair<lst,ex> > > composed;	// compositions shared by the parallelotopes
 
+	for(int i=0; i<this->getCard(); i++){	// for each parallelotope
 
 		Parallelotope *P = this->getParallelotope(i);
 		lst genFun = P->getGeneratorFunction();
 
-		vector< double > base_vertex = P->getBaseVertex();
+		// values of the base vertex and of the lengths
 		vector< double > lengths = P->getLenghts();
-
-		lst subParatope;
-
-		for(int k=0; k<(signed)this->vars[0].nops(); k++){
-			subParatope.append(this->vars[0][k] == base_vertex[k]);
-			subParatope.append(this->vars[2][k] == lengths[k]);
-		}
+		values.push_back(P->getBaseVertex());
+		values.back().insert(values.back().end(),lengths.begin(),lengths.end());
 
 		if(mode == 0){	// static mode
 			dirs_to_bound = this->T[i];
@@ -327,53 +414,91 @@ Bundle* Bundle::transform(lst vars, lst f, map< vector<int>,pair<lst,lst> > &con
 			vector<int> key = this->T[i];
 			key.push_back(dirs_to_bound[j]);
 
-			lst actbernCoeffs;
-
+			if( !controlPts->contains(key,genFun) ){	// check if the coefficients were already computed
 
-			if( controlPts.count(key) == 0 || (!controlPts[key].first.is_equal(genFun)) ){	// check if the coefficients were already computed
+				MemoryScope mem(BERNSTEIN_CACHE);
 
 				// the combination parallelotope/direction to bound is not present in hash table
 				// compute control points
-				lst sub, fog;
-
-				for(int k=0; k<(signed)vars.nops(); k++){
-					sub.append(vars[k] == genFun[k]);
-				}
-				for(int k=0; k<(signed)vars.nops(); k++){
-					fog.append(f[k].subs(sub));
+				// compose only the components of f along the non-zero entries of the direction
+				ex Lfog; Lfog = 0;
+				int dir = dirs_to_bound[j];
+				for(int p=this->Ls.rowBegin(dir); p<this->Ls.rowEnd(dir); p++){
+					Lfog = Lfog + this->Ls.val(p)*this->composeComponent(vars,f,this->Ls.col(p),genFun,composed,controlPts);
 				}
 
-				ex Lfog; Lfog = 0;
-				// upper facets
-				for(int k=0; k<this->getDim(); k++){
-					Lfog = Lfog + this->L[dirs_to_bound[j]][k]*fog[k];
+				lst bern_vars = this->bernVars(dists);
+				lst coeffs;
+				if( this->affineCoeffs(Lfog,bern_vars,params,coeffs) ){	// bounded in closed form, no Bernstein expansion
+					controlPts->insert(key,genFun,this->cacheSymbols(params),values.back().size(),coeffs,true);
+				}else{
+					BaseConverter *BC = new BaseConverter(bern_vars,Lfog);
+					controlPts->insert(key,genFun,this->cacheSymbols(params),values.back().size(),BC->getBernCoeffsMatrix());	// store the computed coefficients
 				}
+			}
 
-				BaseConverter *BC = new BaseConverter(this->vars[1],Lfog);
-				actbernCoeffs = BC->getBernCoeffsMatrix();
+			bound_job job;
+			job.dir = dirs_to_bound[j];
+			job.par = i;
+			job.controlPts = controlPts->find(key);	// kept alive even if evicted by a later insertion
+			jobs.push_back(job);
+		}
+	}
 
-				pair<lst,lst> element (genFun,actbernCoeffs);
-				controlPts[key] = element;	// store the computed coefficients
+	return jobs;
+}
 
-			}else{
-				actbernCoeffs = controlPts[key].second;
-			}
+/**
+ * Transform the bundle
+ *
+ * @param[in] vars variables appearing in the transforming function
+ * @param[in] f transforming function
+ * @param[in,out] controlPts cache of the control points computed so far that might be updated
+ * @param[in] mode transformation mode (0=OFO,1=AFO)
+ * @param[in] dists per-step disturbances (NULL if none)
+ * @returns transformed bundle
+ */
+Bundle* Bundle::transform(lst vars, lst f, ControlPointCache *controlPts, int mode, disturbance_box *dists){
 
-			// find the maximum coefficient
-			double maxCoeffp = -DBL_MAX;
-			double maxCoeffm = -DBL_MAX;
-			for (lst::const_iterator c = actbernCoeffs.begin(); c != actbernCoeffs.end(); ++c){
-				double actCoeffp = ex_to<numeric>((*c).subs(subParatope)).to_double();
-				double actCoeffm = ex_to<numeric>((-(*c)).subs(subParatope)).to_double();
-				maxCoeffp = max(maxCoeffp,actCoeffp);
-				maxCoeffm = max(maxCoeffm,actCoeffm);
-			}
-			newDp[dirs_to_bound[j]] = min(newDp[dirs_to_bound[j]],maxCoeffp);
-			newDm[dirs_to_bound[j]] = min(newDm[dirs_to_bound[j]],maxCoeffm);
+	PerfScope perf(TRANSFORM_PHASE);
+
+	vector< vector< double > > values;
+	vector< bound_job > jobs = this->prepareTransform(vars,lst(),f,controlPts,mode,dists,values);
+
+	// numerical stage: find the maximum coefficient of each job
+	vector< double > jobp (jobs.size()), jobm (jobs.size());
+	ThreadPool::shared()->parallelFor(jobs.size(),[&](int t){
+
+		double maxCoeffp, maxCoeffm;
+		this->maxCoefficients(*jobs[t].controlPts,values[jobs[t].par],NULL,maxCoeffp,maxCoeffm);
+		if( dists != NULL ){	// closed-form bounds of the additive disturbances
+			maxCoeffp += this->additiveBound(jobs[t].dir,1,dists);
+			maxCoeffm += this->additiveBound(jobs[t].dir,-1,dists);
 		}
+		jobp[t] = maxCoeffp;
+		jobm[t] = maxCoeffm;
+	});
+
+	vector<double> newDp (this->getSize(),DBL_MAX);
+	vector<double> newDm (this->getSize(),DBL_MAX);
+	for(int t=0; t<(signed)jobs.size(); t++){
+		newDp[jobs[t].dir] = min(newDp[jobs[t].dir],jobp[t]);
+		newDm[jobs[t].dir] = min(newDm[jobs[t].dir],jobm[t]);
+	}
+
+	// transform the zonotopes and tighten all the offsets with their support functions
+	vector< shared_ptr<Zonotope> > newZ;
+	for(int i=0; i<(signed)this->zonotopes.size(); i++){
+		shared_ptr<Zonotope> Z (this->zonotopes[i]->transform(vars,f,dists));
+		for(int j=0; j<this->getSize(); j++){
+			newDp[j] = min(newDp[j],Z->support(&this->Ls,j,1));
+			newDm[j] = min(newDm[j],Z->support(&this->Ls,j,-1));
+		}
+		newZ.push_back(Z);
 	}
 
 	Bundle *res = new Bundle(this->vars,this->L,newDp,newDm,this->T);
+	res->setZonotopes(newZ);
 	if(mode == 0){
 		res = res->canonize();
 	}
@@ -388,108 +513,369 @@ Bundle* Bundle::transform(lst vars, lst f, map< vector<int>,pair<lst,lst> > &con
  * @param[in] params parameters appearing in the transforming function
  * @param[in] f transforming function
  * @param[in] paraSet set of parameters
- * @param[in,out] controlPts control points computed so far that might be updated
+ * @param[in,out] controlPts cache of the control points computed so far that might be updated
  * @param[in] mode transformation mode (0=OFO,1=AFO)
+ * @param[in] dists per-step disturbances (NULL if none)
  * @returns transformed bundle
  */
-Bundle* Bundle::transform(lst vars, lst params, lst f, LinearSystem *paraSet, map< vector<int>,pair<lst,lst> > &controlPts, int mode){
+Bundle* Bundle::transform(lst vars, lst params, lst f, LinearSystem *paraSet, ControlPointCache *controlPts, int mode, disturbance_box *dists){
+
+	if( !this->zonotopes.empty() ){
+		cout<<"Bundle::transform : the parametric transformation does not support zonotope members";
+		exit (EXIT_FAILURE);
+	}
+
+	PerfScope perf(TRANSFORM_PHASE);
+
+	vector< vector< double > > values;
+	vector< bound_job > jobs = this->prepareTransform(vars,params,f,controlPts,mode,dists,values);
+
+	// numerical stage: maximize each control point over the parameter set
+	vector< double > jobp (jobs.size()), jobm (jobs.size());
+	ThreadPool::shared()->parallelFor(jobs.size(),[&](int t){
+
+		double maxCoeffp, maxCoeffm;
+		this->maxCoefficients(*jobs[t].controlPts,values[jobs[t].par],paraSet,maxCoeffp,maxCoeffm);
+		if( dists != NULL ){	// closed-form bounds of the additive disturbances
+			maxCoeffp += this->additiveBound(jobs[t].dir,1,dists);
+			maxCoeffm += this->additiveBound(jobs[t].dir,-1,dists);
+		}
+		jobp[t] = maxCoeffp;
+		jobm[t] = maxCoeffm;
+	});
 
 	vector<double> newDp (this->getSize(),DBL_MAX);
 	vector<double> newDm (this->getSize(),DBL_MAX);
+	for(int t=0; t<(signed)jobs.size(); t++){
+		newDp[jobs[t].dir] = min(newDp[jobs[t].dir],jobp[t]);
+		newDm[jobs[t].dir] = min(newDm[jobs[t].dir],jobm[t]);
+	}
 
-	vector<int> dirs_to_bound;
-	if(mode){	// dynamic transformation
-		for(int i=0; i<(signed)this->L.size(); i++){
-			dirs_to_bound.push_back(i);
-		}
+	Bundle *res = new Bundle(this->vars,this->L,newDp,newDm,this->T);
+	if(mode == 0){
+		res = res->canonize();
 	}
 
-	for(int i=0; i<this->getCard(); i++){	// for each parallelotope
+	return res;
+}
+
+
+/**
+ * Modes of piecewise dynamics that might be active on the bundle. The guards
+ * of each mode are composed with the generator function of each parallelotope
+ * and a mode is inactive if the minimum Bernstein coefficient of one of its
+ * guards is positive on a parallelotope (that contains the bundle)
+ *
+ * @param[in] vars variables appearing in the guards
+ * @param[in] guards guards of each mode (the mode is active where they are all non-positive)
+ * @param[in,out] guardPts cache of the control points of the guards that might be updated
+ * @returns for each mode, false if it is certainly inactive
+ */
+vector< bool > Bundle::activeModes(lst vars, vector< lst > guards, ControlPointCache *guardPts){
 
+	vector< bool > active (guards.size(),true);
+	vector< map< int, vector< pair<lst,ex> > > > composed (guards.size());	// compositions shared by the parallelotopes
+
+	for(int i=0; i<this->getCard(); i++){	// for each parallelotope
 
 		Parallelotope *P = this->getParallelotope(i);
 		lst genFun = P->getGeneratorFunction();
 
-		vector< double > base_vertex = P->getBaseVertex();
+		// values of the base vertex and of the lengths
+		vector< double > values = P->getBaseVertex();
 		vector< double > lengths = P->getLenghts();
+		values.insert(values.end(),lengths.begin(),lengths.end());
 
-		lst subParatope;
+		for(int m=0; m<(signed)guards.size(); m++){
+			for(int g=0; g<(signed)guards[m].nops() && active[m]; g++){
 
-		for(int k=0; k<(signed)this->vars[0].nops(); k++){
-			subParatope.append(this->vars[0][k] == base_vertex[k]);
-			subParatope.append(this->vars[2][k] == lengths[k]);
-		}
+				// key of the control points: template, mode and guard
+				vector<int> key = this->T[i];
+				key.push_back(m);
+				key.push_back(g);
 
+				if( !guardPts->contains(key,genFun) ){
 
-		if(mode == 0){	// static mode
-			dirs_to_bound = this->T[i];
+					MemoryScope mem(BERNSTEIN_CACHE);
+
+					ex gog = this->composeComponent(vars,guards[m],g,genFun,composed[m],guardPts);
+					lst coeffs;
+					if( this->affineCoeffs(gog,this->vars[1],lst(),coeffs) ){	// bounded in closed form
+						guardPts->insert(key,genFun,this->cacheSymbols(lst()),values.size(),coeffs,true);
+					}else{
+						BaseConverter *BC = new BaseConverter(this->vars[1],gog);
+						guardPts->insert(key,genFun,this->cacheSymbols(lst()),values.size(),BC->getBernCoeffsMatrix());
+					}
+				}
+
+				// minimum of the guard over the parallelotope
+				shared_ptr<const compact_points> guardCoeffs = guardPts->find(key);
+				vector< vector< double > > rows = ControlPointCache::evaluate(*guardCoeffs,values);
+				double min_guard = rows[0][0];
+				for(int c=1; c<(signed)rows.size(); c++){
+					min_guard = guardCoeffs->affine ? min_guard + min(0.0,rows[c][0]) : min(min_guard,rows[c][0]);
+				}
+				if( min_guard > 0 ){
+					active[m] = false;
+				}
+			}
 		}
+	}
 
-		for(int j=0; j<(signed)dirs_to_bound.size(); j++){	// for each direction
+	return active;
+}
 
-			// key of the control points
-			vector<int> key = this->T[i];
-			key.push_back(dirs_to_bound[j]);
+/**
+ * Transform the bundle with piecewise dynamics. Only the modes that might be
+ * active on the bundle are bounded, and the offsets of the result are the
+ * maxima of the offsets of their images
+ *
+ * @param[in] vars variables appearing in the dynamics and in the guards
+ * @param[in] params parameters appearing in the dynamics (empty if none)
+ * @param[in] fs dynamics of each mode
+ * @param[in] guards guards of each mode
+ * @param[in] paraSet set of parameters (NULL for the non-parametric transformation)
+ * @param[in,out] controlPts caches of the control points of each mode that might be updated
+ * @param[in,out] guardPts cache of the control points of the guards that might be updated
+ * @param[in] mode transformation mode (0=OFO,1=AFO)
+ * @param[out] num_active number of modes bounded
+ * @returns transformed bundle
+ */
+Bundle* Bundle::transform(lst vars, lst params, vector< lst > fs, vector< lst > guards, LinearSystem *paraSet,
+		vector< ControlPointCache* > controlPts, ControlPointCache *guardPts, int mode, int &num_active){
 
-			lst actbernCoeffs;
+	vector< bool > active = this->activeModes(vars,guards,guardPts);
 
+	vector< Bundle* > images;
+	for(int m=0; m<(signed)fs.size(); m++){
+		if( active[m] ){
+			if( paraSet == NULL ){
+				images.push_back(this->transform(vars,fs[m],controlPts[m],mode));
+			}else{
+				images.push_back(this->transform(vars,params,fs[m],paraSet,controlPts[m],mode));
+			}
+		}
+	}
 
-			if( controlPts.count(key) == 0 || (!controlPts[key].first.is_equal(genFun)) ){	// check if the coefficients were already computed
+	num_active = images.size();
+	if( images.empty() ){
+		cout<<"Bundle::transform : no active mode, the guards do not cover the reach set";
+		exit (EXIT_FAILURE);
+	}
+	if( images.size() == 1 ){	// a single mode keeps its zonotopes
+		return images[0];
+	}
 
-				// the combination parallelotope/direction to bound is not present in hash table
-				// compute control points
-				lst sub, fog;
+	// union of the images (the zonotope members are not propagated)
+	vector<double> newDp = images[0]->offp;
+	vector<double> newDm = images[0]->offm;
+	for(int m=1; m<(signed)images.size(); m++){
+		for(int j=0; j<this->getSize(); j++){
+			newDp[j] = max(newDp[j],images[m]->offp[j]);
+			newDm[j] = max(newDm[j],images[m]->offm[j]);
+		}
+		delete images[m];
+	}
+	delete images[0];
 
+	Bundle *res = new Bundle(this->vars,this->L,newDp,newDm,this->T);
+	if(mode == 0){
+		res = res->canonize();
+	}
 
-				int pio = 0;
+	return res;
+}
 
-				for(int k=0; k<(signed)vars.nops(); k++){
-					sub.append(vars[k] == genFun[k]);
-				}
 
-				for(int k=0; k<(signed)vars.nops(); k++){
-					fog.append(f[k].subs(sub));
-				}
+/**
+ * Maximum of the control points of a parallelotope/direction pair and of
+ * their opposites. Affine functions c0 + sum_i c_i x_i are bounded in closed
+ * form over [0,1]^n by c0 + sum_i max(0,c_i)
+ *
+ * @param[in] controlPts control points of the pair
+ * @param[in] values base vertex and lengths of the parallelotope
+ * @param[in] paraSet set of parameters (NULL if none)
+ * @param[out] maxCoeffp maximum of the control points
+ * @param[out] maxCoeffm maximum of the opposite of the control points
+ */
+void Bundle::maxCoefficients(const compact_points &controlPts, const vector< double > &values, LinearSystem *paraSet,
+		double &maxCoeffp, double &maxCoeffm){
+
+	// constant term and coefficients of the parameters
+	vector< vector< double > > actbernCoeffs = ControlPointCache::evaluate(controlPts,values);
+
+	// the control points (or the constant term of an affine function) maximized over the parameters
+	int num_pts = controlPts.affine ? 1 : actbernCoeffs.size();
+	maxCoeffp = -DBL_MAX;
+	maxCoeffm = -DBL_MAX;
+	for(int c=0; c<num_pts; c++){
+		double maxp = actbernCoeffs[c][0];
+		double maxm = -actbernCoeffs[c][0];
+		if( paraSet != NULL ){
+			vector< double > coeffp (actbernCoeffs[c].begin()+1,actbernCoeffs[c].end());
+			vector< double > coeffm (coeffp.size());
+			for(int k=0; k<(signed)coeffp.size(); k++){
+				coeffm[k] = -coeffp[k];
+			}
+			maxp += paraSet->maxLinearSystem(coeffp);
+			maxm += paraSet->maxLinearSystem(coeffm);
+		}
+		maxCoeffp = max(maxCoeffp,maxp);
+		maxCoeffm = max(maxCoeffm,maxm);
+	}
 
-				ex Lfog; Lfog = 0;
-				// upper facets
-				for(int k=0; k<this->getDim(); k++){
-					Lfog = Lfog + this->L[dirs_to_bound[j]][k]*fog[k];
-				}
+	if( controlPts.affine ){	// the coefficients of the variables do not depend on the parameters
+		for(int c=1; c<(signed)actbernCoeffs.size(); c++){
+			maxCoeffp += max(0.0,actbernCoeffs[c][0]);
+			maxCoeffm += max(0.0,-actbernCoeffs[c][0]);
+		}
+	}
+}
+
+/**
+ * Check whether a polynomial is affine in some variables and extract its
+ * coefficients. With parameters, the coefficients of the variables must not
+ * depend on them (so that the closed-form bound needs a single LP)
+ *
+ * @param[in] e polynomial
+ * @param[in] vars variables \in [0,1]
+ * @param[in] params parameters
+ * @param[out] coeffs constant term followed by the coefficient of each variable
+ * @returns true if e is affine in vars
+ */
+bool Bundle::affineCoeffs(ex e, lst vars, lst params, lst &coeffs){
 
-				BaseConverter *BC = new BaseConverter(this->vars[1],Lfog);
-				actbernCoeffs = BC->getBernCoeffsMatrix();
+	ex poly = e.expand();
 
-				pair<lst,lst> element (genFun,actbernCoeffs);
-				controlPts[key] = element;	// store the computed coefficients
+	// total degree in the variables
+	symbol t("t");
+	lst scale, zero;
+	for(int i=0; i<(signed)vars.nops(); i++){
+		scale.append(vars[i] == t*vars[i]);
+		zero.append(vars[i] == 0);
+	}
+	if( poly.subs(scale).expand().degree(t) > 1 ){
+		return false;
+	}
 
-			}else{
-				actbernCoeffs = controlPts[key].second;
+	coeffs = lst();
+	coeffs.append(poly.subs(zero));
+	for(int i=0; i<(signed)vars.nops(); i++){
+		ex c = poly.coeff(vars[i],1);
+		for(int k=0; k<(signed)params.nops(); k++){
+			if( c.has(params[k]) ){
+				return false;
 			}
+		}
+		coeffs.append(c);
+	}
+	return true;
+}
+
+/**
+ * Compose the k-th component of f with a generator function. The expanded
+ * composition is shared by all the parallelotopes whose generator functions
+ * agree on the variables appearing in f[k], e.g., templates that differ only
+ * in directions that do not affect these variables
+ *
+ * @param[in] vars variables appearing in the transforming function
+ * @param[in] f transforming function
+ * @param[in] k component to compose
+ * @param[in] genFun generator function of the parallelotope
+ * @param[in,out] composed compositions computed so far for each component
+ * @param[in,out] controlPts cache whose composition statistics are updated
+ * @returns expanded f[k](genFun)
+ */
+ex Bundle::composeComponent(lst vars, lst f, int k, lst genFun, map< int, vector< pair<lst,ex> > > &composed, ControlPointCache *controlPts){
+
+	// generator function restricted to the variables of f[k]
+	lst sub, key;
+	for(int i=0; i<(signed)vars.nops(); i++){
+		if( f[k].has(vars[i]) ){
+			sub.append(vars[i] == genFun[i]);
+			key.append(genFun[i]);
+		}
+	}
+
+	vector< pair<lst,ex> > &known = composed[k];
+	for(int i=0; i<(signed)known.size(); i++){
+		if( known[i].first.is_equal(key) ){
+			controlPts->countComposition(true);
+			return known[i].second;
+		}
+	}
+
+	controlPts->countComposition(false);
+	ex fog = f[k].subs(sub).expand();
+	known.push_back(pair<lst,ex> (key,fog));
+	return fog;
+}
+
+/**
+ * Variables of the Bernstein expansion: the free variables of the parallelotopes
+ * and the variables of the disturbances that do not enter additively
+ *
+ * @param[in] dists per-step disturbances (NULL if none)
+ * @returns list of variables \in [0,1]
+ */
+lst Bundle::bernVars(disturbance_box *dists){
 
-			// find the maximum coefficient
-			double maxCoeffp = -DBL_MAX;
-			double maxCoeffm = -DBL_MAX;
-			for (lst::const_iterator c = actbernCoeffs.begin(); c != actbernCoeffs.end(); ++c){
-				ex paraBernCoeff;
-				paraBernCoeff = (*c).subs(subParatope);
-				maxCoeffp = max(maxCoeffp,paraSet->maxLinearSystem(params,paraBernCoeff));
-				maxCoeffm = max(maxCoeffm,paraSet->maxLinearSystem(params,-paraBernCoeff));
+	lst bern_vars = this->vars[1];
+	if( dists != NULL ){
+		for(int i=0; i<(signed)dists->deltas.nops(); i++){
+			if( !dists->additive[i] ){
+				bern_vars.append(dists->deltas[i]);
 			}
-			newDp[dirs_to_bound[j]] = min(newDp[dirs_to_bound[j]],maxCoeffp);
-			newDm[dirs_to_bound[j]]  = min(newDm[dirs_to_bound[j]],maxCoeffm);
 		}
 	}
+	return bern_vars;
+}
 
-	Bundle *res = new Bundle(this->vars,this->L,newDp,newDm,this->T);
-	if(mode == 0){
-		res = res->canonize();
+/**
+ * Symbols of the cached control points: base vertex and lengths (evaluated
+ * for each parallelotope) followed by the parameters
+ *
+ * @param[in] params parameters
+ * @returns list of symbols
+ */
+lst Bundle::cacheSymbols(lst params){
+
+	lst syms;
+	for(int k=0; k<(signed)this->vars[0].nops(); k++){
+		syms.append(this->vars[0][k]);
+	}
+	for(int k=0; k<(signed)this->vars[2].nops(); k++){
+		syms.append(this->vars[2][k]);
 	}
+	for(int k=0; k<(signed)params.nops(); k++){
+		syms.append(params[k]);
+	}
+	return syms;
+}
 
+/**
+ * Maximum of sign*L[dir]*D*d over the box of the additive disturbances
+ *
+ * @param[in] dir index of the direction
+ * @param[in] sign 1 for the upper offset, -1 for the lower one
+ * @param[in] dists per-step disturbances
+ * @returns maximum contribution of the additive disturbances along the direction
+ */
+double Bundle::additiveBound(int dir, double sign, disturbance_box *dists){
+
+	double res = 0;
+	for(int i=0; i<(signed)dists->lb.size(); i++){
+		if( dists->additive[i] ){
+			double c = 0;
+			for(int p=this->Ls.rowBegin(dir); p<this->Ls.rowEnd(dir); p++){
+				c += sign*this->Ls.val(p)*dists->D[this->Ls.col(p)][i];
+			}
+			res += max(c*dists->lb[i],c*dists->ub[i]);
+		}
+	}
 	return res;
 }
 
-
 /**
  * Set the bundle template
  *
@@ -552,7 +938,8 @@ double Bundle::prod(vector<double> v1, vector<double> v2){
  * @returns angle between v1 and v2
  */
 double Bundle::angle(vector<double> v1, vector<double> v2){
-	return acos(this->prod(v1,v2)/(this->norm(v1)*this->norm(v2)));
+	double c = this->prod(v1,v2)/(this->norm(v1)*this->norm(v2));
+	return acos(max(-1.0,min(1.0,c)));
 }
 
 /**
@@ -567,6 +954,17 @@ double Bundle::orthProx(vector<double> v1, vector<double> v2){
 	return abs(this->angle(v1,v2) - (3.14159265/2));
 }
 
+/**
+ * Orthogonal proximity of the directions i and j computed on the sparse rows
+ *
+ * @param[in] i index of the first direction
+ * @param[in] j index of the second direction
+ * @returns orthogonal proximity
+ */
+double Bundle::orthProx(int i, int j){
+	return this->Ls.orthProx(i,j);
+}
+
 /**
  * Maximum orthogonal proximity of a vector w.r.t. a set of vectors
  *
@@ -582,7 +980,7 @@ double Bundle::maxOrthProx(int vIdx, vector<int> dirsIdx){
 
 	double maxProx = 0;
 	for( int i=0; i<dirsIdx.size(); i++ ){
-		maxProx = max(maxProx, this->orthProx(this->L[vIdx],this->L[dirsIdx[i]]));
+		maxProx = max(maxProx, this->Theta[vIdx][dirsIdx[i]]);
 	}
 	return maxProx;
 }
@@ -597,7 +995,7 @@ double Bundle::maxOrthProx(vector<int> dirsIdx){
 	double maxProx = 0;
 	for( int i=0; i<dirsIdx.size(); i++ ){
 		for(int j=i+1; j<dirsIdx.size(); j++){
-			maxProx = max(maxProx, this->orthProx(this->L[dirsIdx[i]],this->L[dirsIdx[j]]));
+			maxProx = max(maxProx, this->Theta[dirsIdx[i]][dirsIdx[j]]);
 		}
 	}
 	return maxProx;
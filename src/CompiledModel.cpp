@@ -0,0 +1,509 @@
+/**
+ * @file CompiledModel.cpp
+ * Numerical reachability and monitoring of a compiled model, and the
+ * binary format of the artifact
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "CompiledModel.h"
+
+#include <fstream>
+#include <float.h>
+#include <glpk.h>
+
+/**
+ * Constructor that instantiates an artifact without templates (used by the
+ * model compiler)
+ *
+ * @param[in] name name of the model
+ * @param[in] dim number of variables
+ * @param[in] num_params number of parameters (0: non-parametric)
+ * @param[in] mode transformation mode (0=OFO,1=AFO)
+ * @param[in] L direction matrix
+ * @param[in] offp upper offsets of the initial set
+ * @param[in] offm lower offsets of the initial set
+ * @param[in] paraA directions of the parameter set (empty if non-parametric)
+ * @param[in] parab offsets of the parameter set
+ */
+CompiledModel::CompiledModel(string name, int dim, int num_params, int mode, vector< vector< double > > L, vector< double > offp,
+		vector< double > offm, vector< vector< double > > paraA, vector< double > parab){
+
+	if( offp.size() != L.size() || offm.size() != L.size() ){
+		cout<<"CompiledModel::CompiledModel : L, offp and offm must have the same size";
+		exit (EXIT_FAILURE);
+	}
+	if( num_params > 0 && paraA.empty() ){
+		cout<<"CompiledModel::CompiledModel : a parametric model needs a parameter set";
+		exit (EXIT_FAILURE);
+	}
+
+	this->name = name;
+	this->dim = dim;
+	this->num_params = num_params;
+	this->mode = mode;
+	this->L = L;
+	this->offp = offp;
+	this->offm = offm;
+	this->paraA = paraA;
+	this->parab = parab;
+}
+
+/**
+ * Add a compiled parallelotope
+ *
+ * @param[in] dirs directions of the template
+ * @param[in] bound_dirs directions bounded by the parallelotope
+ * @param[in] controlPts control points of each bounded direction
+ */
+void CompiledModel::addTemplate(vector< int > dirs, vector< int > bound_dirs, vector< compact_points > controlPts){
+
+	if( (signed)dirs.size() != this->dim || bound_dirs.size() != controlPts.size() ){
+		cout<<"CompiledModel::addTemplate : wrong template sizes";
+		exit (EXIT_FAILURE);
+	}
+
+	compiled_template t;
+	t.dirs = dirs;
+	t.bound_dirs = bound_dirs;
+	t.controlPts = controlPts;
+
+	vector< vector< double > > Lambda;
+	for(int j=0; j<this->dim; j++){
+		Lambda.push_back(this->L[dirs[j]]);
+	}
+	if( !DenseMatrix::invert(Lambda,t.Linv) ){
+		cout<<"CompiledModel::addTemplate : singular template";
+		exit (EXIT_FAILURE);
+	}
+	for(int k=0; k<this->dim; k++){
+		double norm = 0;
+		for(int j=0; j<this->dim; j++){
+			norm += t.Linv[j][k]*t.Linv[j][k];
+		}
+		t.col_norms.push_back(sqrt(norm));
+	}
+
+	this->templates.push_back(t);
+}
+
+/**
+ * Numerical conversion of a parallelotope from constraints to generators.
+ * The base vertex q solves Lambda q = offp and the k-th generator is the
+ * k-th column of Lambda^-1 scaled by the width offp_k + offm_k
+ *
+ * @param[in] i index of the template
+ * @param[in] offp upper offsets of the bundle
+ * @param[in] offm lower offsets of the bundle
+ * @returns base vertex followed by the lengths of the generators
+ */
+vector< double > CompiledModel::const2gen(int i, const vector< double > &offp, const vector< double > &offm){
+
+	compiled_template &t = this->templates[i];
+
+	vector< double > d;
+	for(int k=0; k<this->dim; k++){
+		d.push_back(offp[t.dirs[k]]);
+	}
+	vector< double > values = DenseMatrix::mult(t.Linv,d);
+	values.resize(2*this->dim);
+	for(int k=0; k<this->dim; k++){
+		values[this->dim+k] = (offp[t.dirs[k]] + offm[t.dirs[k]])*t.col_norms[k];
+	}
+	return values;
+}
+
+/**
+ * Maximize a linear function over the parameter set
+ *
+ * @param[in] obj_fun coefficients of the parameters
+ * @returns maximum
+ */
+double CompiledModel::maxParams(const vector< double > &obj_fun){
+	return CompiledModel::lpMax(this->paraA,this->parab,obj_fun);
+}
+
+/**
+ * Tighten the offsets of a bundle to its support functions
+ *
+ * @param[in,out] offp upper offsets
+ * @param[in,out] offm lower offsets
+ */
+void CompiledModel::canonize(vector< double > &offp, vector< double > &offm){
+
+	vector< vector< double > > A;
+	vector< double > b;
+	for(int i=0; i<(signed)this->L.size(); i++){
+		vector< double > neg (this->dim);
+		for(int j=0; j<this->dim; j++){
+			neg[j] = -this->L[i][j];
+		}
+		A.push_back(this->L[i]);
+		b.push_back(offp[i]);
+		A.push_back(neg);
+		b.push_back(offm[i]);
+	}
+
+	for(int i=0; i<(signed)this->L.size(); i++){
+		offp[i] = CompiledModel::lpMax(A,b,A[2*i]);
+		offm[i] = CompiledModel::lpMax(A,b,A[2*i+1]);
+	}
+}
+
+/**
+ * One reachability step: the control points of each parallelotope/direction
+ * pair are evaluated and bounded in parallel (as Bundle::maxCoefficients:
+ * an affine pair is bounded by its constant term, maximized over the
+ * parameters, plus the positive coefficients of the variables in [0,1])
+ *
+ * @param[in,out] offp upper offsets of the bundle
+ * @param[in,out] offm lower offsets of the bundle
+ */
+void CompiledModel::step(vector< double > &offp, vector< double > &offm){
+
+	vector< vector< double > > values;
+	vector< pair< int,int > > jobs;		// template and bounded direction
+	for(int i=0; i<(signed)this->templates.size(); i++){
+		values.push_back(this->const2gen(i,offp,offm));
+		for(int j=0; j<(signed)this->templates[i].bound_dirs.size(); j++){
+			jobs.push_back(pair< int,int > (i,j));
+		}
+	}
+
+	vector< double > jobp (jobs.size()), jobm (jobs.size());
+	ThreadPool::shared()->parallelFor(jobs.size(),[&](int t){
+
+		compiled_template &temp = this->templates[jobs[t].first];
+		vector< vector< double > > coeffs = ControlPointCache::evaluate(temp.controlPts[jobs[t].second],values[jobs[t].first]);
+
+		const compact_points &pts = temp.controlPts[jobs[t].second];
+		int num_pts = pts.affine ? 1 : coeffs.size();
+		double maxCoeffp = -DBL_MAX;
+		double maxCoeffm = -DBL_MAX;
+		for(int c=0; c<num_pts; c++){
+			if( this->num_params == 0 ){
+				maxCoeffp = max(maxCoeffp,coeffs[c][0]);
+				maxCoeffm = max(maxCoeffm,-coeffs[c][0]);
+			}else{
+				vector< double > coeffp (coeffs[c].begin()+1,coeffs[c].end());
+				vector< double > coeffm (coeffp.size());
+				for(int k=0; k<(signed)coeffp.size(); k++){
+					coeffm[k] = -coeffp[k];
+				}
+				maxCoeffp = max(maxCoeffp,coeffs[c][0] + this->maxParams(coeffp));
+				maxCoeffm = max(maxCoeffm,-coeffs[c][0] + this->maxParams(coeffm));
+			}
+		}
+		if( pts.affine ){
+			for(int c=1; c<(signed)coeffs.size(); c++){
+				maxCoeffp += max(0.0,coeffs[c][0]);
+				maxCoeffm += max(0.0,-coeffs[c][0]);
+			}
+		}
+		jobp[t] = maxCoeffp;
+		jobm[t] = maxCoeffm;
+	});
+
+	vector< double > newDp (this->L.size(),DBL_MAX);
+	vector< double > newDm (this->L.size(),DBL_MAX);
+	for(int t=0; t<(signed)jobs.size(); t++){
+		int dir = this->templates[jobs[t].first].bound_dirs[jobs[t].second];
+		newDp[dir] = min(newDp[dir],jobp[t]);
+		newDm[dir] = min(newDm[dir],jobm[t]);
+	}
+
+	offp = newDp;
+	offm = newDm;
+	if( this->mode == 0 ){
+		this->canonize(offp,offm);
+	}
+}
+
+/**
+ * Reachability from the initial set
+ *
+ * @param[in] k number of steps
+ * @param[out] offps upper offsets of the steps 0,...,k
+ * @param[out] offms lower offsets of the steps 0,...,k
+ */
+void CompiledModel::reach(int k, vector< vector< double > > &offps, vector< vector< double > > &offms){
+
+	offps.clear();
+	offms.clear();
+
+	vector< double > offp = this->offp;
+	vector< double > offm = this->offm;
+	offps.push_back(offp);
+	offms.push_back(offm);
+	for(int i=0; i<k; i++){
+		this->step(offp,offm);
+		offps.push_back(offp);
+		offms.push_back(offm);
+	}
+}
+
+/**
+ * Store a flowpipe in the binary format of Flowpipe::saveToFile
+ *
+ * @param[in] file_name name of the file
+ * @param[in] offps upper offsets of each step
+ * @param[in] offms lower offsets of each step
+ */
+void CompiledModel::saveFlowpipe(string file_name, vector< vector< double > > &offps, vector< vector< double > > &offms){
+
+	ofstream out;
+	out.open (file_name.c_str(), ios_base::out | ios_base::binary);
+	if( !out.is_open() ){
+		cout<<"CompiledModel::saveFlowpipe : cannot open "<<file_name;
+		exit (EXIT_FAILURE);
+	}
+
+	int version = 1;
+	int num_dirs = this->L.size();
+	out.write("SAPF",4);
+	out.write((char*)&version,sizeof(int));
+	out.write((char*)&this->dim,sizeof(int));
+	out.write((char*)&num_dirs,sizeof(int));
+	for(int i=0; i<num_dirs; i++){
+		out.write((char*)&this->L[i][0],this->dim*sizeof(double));
+	}
+	for(int i=0; i<(signed)offps.size(); i++){
+		out.write((char*)&offps[i][0],num_dirs*sizeof(double));
+		out.write((char*)&offms[i][0],num_dirs*sizeof(double));
+	}
+
+	out.close();
+}
+
+/**
+ * Monitor a trace: the i-th point is checked against the bundle of the i-th step
+ *
+ * @param[in] points states of the trace
+ * @param[in] offps upper offsets of each step
+ * @param[in] offms lower offsets of each step
+ * @returns maximum violation of the offsets of each checked point (<= 0: inside)
+ */
+vector< double > CompiledModel::violations(const vector< vector< double > > &points, vector< vector< double > > &offps, vector< vector< double > > &offms){
+
+	int n = min(points.size(),offps.size());
+	vector< double > viol (n,-DBL_MAX);
+	for(int i=0; i<n; i++){
+		if( (signed)points[i].size() != this->dim ){
+			cout<<"CompiledModel::violations : points must have "<<this->dim<<" coordinates";
+			exit (EXIT_FAILURE);
+		}
+		for(int j=0; j<(signed)this->L.size(); j++){
+			double Lx = 0;
+			for(int k=0; k<this->dim; k++){
+				Lx += this->L[j][k]*points[i][k];
+			}
+			viol[i] = max(viol[i],max(Lx - offps[i][j],-Lx - offms[i][j]));
+		}
+	}
+	return viol;
+}
+
+/**
+ * Maximize a linear function over the polytope A x <= b
+ *
+ * @param[in] A directions of the polytope
+ * @param[in] b offsets of the polytope
+ * @param[in] obj_fun objective function
+ * @returns maximum
+ */
+double CompiledModel::lpMax(const vector< vector< double > > &A, const vector< double > &b, const vector< double > &obj_fun){
+
+	int num_rows = A.size();
+	int num_cols = obj_fun.size();
+
+	glp_prob *lp = glp_create_prob();
+	glp_set_obj_dir(lp, GLP_MAX);
+
+	// Turn off verbose mode
+	glp_smcp lp_param;
+	glp_init_smcp(&lp_param);
+	lp_param.msg_lev = GLP_MSG_ERR;
+
+	glp_add_rows(lp, num_rows);
+	for(int i=0; i<num_rows; i++){
+		glp_set_row_bnds(lp, i+1, GLP_UP, 0.0, b[i]);
+	}
+	glp_add_cols(lp, num_cols);
+	for(int j=0; j<num_cols; j++){
+		glp_set_col_bnds(lp, j+1, GLP_FR, 0.0, 0.0);
+		glp_set_obj_coef(lp, j+1, obj_fun[j]);
+	}
+
+	vector< int > ia (1), ja (1);
+	vector< double > ar (1);
+	for(int i=0; i<num_rows; i++){
+		for(int j=0; j<num_cols; j++){
+			if( A[i][j] != 0 ){		// load only the non-zero elements
+				ia.push_back(i+1), ja.push_back(j+1), ar.push_back(A[i][j]);
+			}
+		}
+	}
+
+	glp_load_matrix(lp, ia.size()-1, &ia[0], &ja[0], &ar[0]);
+	glp_simplex(lp, &lp_param);
+	double res = glp_get_obj_val(lp);
+	glp_delete_prob(lp);
+
+	return res;
+}
+
+// binary I/O of the artifacts
+static void writeInt(ofstream &out, int v){ out.write((char*)&v,sizeof(int)); }
+static void writeDoubles(ofstream &out, const vector< double > &v){ if(!v.empty()){ out.write((char*)&v[0],v.size()*sizeof(double)); } }
+static int readInt(ifstream &in){ int v = 0; in.read((char*)&v,sizeof(int)); return v; }
+static vector< double > readDoubles(ifstream &in, int n){ vector< double > v (n); if(n > 0){ in.read((char*)&v[0],n*sizeof(double)); } return v; }
+
+/**
+ * Store the artifact in binary format. The file starts with the header
+ * "SAPM" and the format version (2: the control points carry the affine
+ * flag), followed by the model, the initial set, the parameter set and the
+ * compiled templates
+ *
+ * @param[in] file_name name of the file
+ */
+void CompiledModel::save(string file_name){
+
+	ofstream out;
+	out.open (file_name.c_str(), ios_base::out | ios_base::binary);
+	if( !out.is_open() ){
+		cout<<"CompiledModel::save : cannot open "<<file_name;
+		exit (EXIT_FAILURE);
+	}
+
+	out.write("SAPM",4);
+	writeInt(out,2);
+	writeInt(out,this->name.size());
+	out.write(this->name.c_str(),this->name.size());
+	writeInt(out,this->dim);
+	writeInt(out,this->num_params);
+	writeInt(out,this->mode);
+
+	// initial set
+	writeInt(out,this->L.size());
+	for(int i=0; i<(signed)this->L.size(); i++){
+		writeDoubles(out,this->L[i]);
+	}
+	writeDoubles(out,this->offp);
+	writeDoubles(out,this->offm);
+
+	// parameter set
+	writeInt(out,this->paraA.size());
+	for(int i=0; i<(signed)this->paraA.size(); i++){
+		writeDoubles(out,this->paraA[i]);
+	}
+	writeDoubles(out,this->parab);
+
+	// templates
+	writeInt(out,this->templates.size());
+	for(int i=0; i<(signed)this->templates.size(); i++){
+		compiled_template &t = this->templates[i];
+		out.write((char*)&t.dirs[0],this->dim*sizeof(int));
+		for(int j=0; j<this->dim; j++){
+			writeDoubles(out,t.Linv[j]);
+		}
+		writeDoubles(out,t.col_norms);
+		writeInt(out,t.bound_dirs.size());
+		for(int j=0; j<(signed)t.bound_dirs.size(); j++){
+			compact_points &pts = t.controlPts[j];
+			writeInt(out,t.bound_dirs[j]);
+			writeInt(out,pts.num_syms);
+			writeInt(out,pts.num_vals);
+			writeInt(out,pts.affine);
+			writeInt(out,pts.polys.size());
+			for(int c=0; c<(signed)pts.polys.size(); c++){
+				writeInt(out,pts.polys[c].coeffs.size());
+				writeDoubles(out,pts.polys[c].coeffs);
+				if( !pts.polys[c].exps.empty() ){
+					out.write((char*)&pts.polys[c].exps[0],pts.polys[c].exps.size());
+				}
+			}
+		}
+	}
+
+	out.close();
+}
+
+/**
+ * Constructor that loads an artifact stored by save
+ *
+ * @param[in] file_name name of the file
+ */
+CompiledModel::CompiledModel(string file_name){
+
+	ifstream in;
+	in.open (file_name.c_str(), ios_base::in | ios_base::binary);
+	char header[4];
+	int version = 0;
+	if( !in.is_open() || !in.read(header,4) || string(header,4) != "SAPM" || ((version = readInt(in)) != 1 && version != 2) ){
+		cout<<"CompiledModel::CompiledModel : "<<file_name<<" is not a model artifact";
+		exit (EXIT_FAILURE);
+	}
+
+	int name_size = readInt(in);
+	vector< char > name (name_size);
+	if( name_size > 0 ){
+		in.read(&name[0],name_size);
+	}
+	this->name = string(name.begin(),name.end());
+	this->dim = readInt(in);
+	this->num_params = readInt(in);
+	this->mode = readInt(in);
+
+	// initial set
+	int num_dirs = readInt(in);
+	for(int i=0; i<num_dirs; i++){
+		this->L.push_back(readDoubles(in,this->dim));
+	}
+	this->offp = readDoubles(in,num_dirs);
+	this->offm = readDoubles(in,num_dirs);
+
+	// parameter set
+	int num_rows = readInt(in);
+	for(int i=0; i<num_rows; i++){
+		this->paraA.push_back(readDoubles(in,this->num_params));
+	}
+	this->parab = readDoubles(in,num_rows);
+
+	// templates
+	int num_temps = readInt(in);
+	for(int i=0; i<num_temps; i++){
+		compiled_template t;
+		t.dirs = vector< int > (this->dim);
+		in.read((char*)&t.dirs[0],this->dim*sizeof(int));
+		for(int j=0; j<this->dim; j++){
+			t.Linv.push_back(readDoubles(in,this->dim));
+		}
+		t.col_norms = readDoubles(in,this->dim);
+		int num_bound = readInt(in);
+		for(int j=0; j<num_bound; j++){
+			compact_points pts;
+			t.bound_dirs.push_back(readInt(in));
+			pts.num_syms = readInt(in);
+			pts.num_vals = readInt(in);
+			pts.affine = version >= 2 && readInt(in) != 0;	// version 1: Bernstein control points only
+			pts.polys = vector< compact_poly > (readInt(in));
+			for(int c=0; c<(signed)pts.polys.size(); c++){
+				int num_terms = readInt(in);
+				pts.polys[c].coeffs = readDoubles(in,num_terms);
+				pts.polys[c].exps = vector< unsigned char > (num_terms*pts.num_syms);
+				if( !pts.polys[c].exps.empty() ){
+					in.read((char*)&pts.polys[c].exps[0],pts.polys[c].exps.size());
+				}
+			}
+			t.controlPts.push_back(pts);
+		}
+		this->templates.push_back(t);
+	}
+
+	if( !in ){
+		cout<<"CompiledModel::CompiledModel : "<<file_name<<" is truncated";
+		exit (EXIT_FAILURE);
+	}
+	in.close();
+}
@@ -0,0 +1,266 @@
+/**
+ * @file ControlPointCache.cpp
+ * LRU bookkeeping of the control points cache, conversion of GiNaC
+ * polynomials into compact form, and their numerical evaluation
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "ControlPointCache.h"
+
+#include <sstream>
+
+#ifndef SAPO_RUNTIME
+
+/**
+ * Constructor that instantiates an empty cache
+ *
+ * @param[in] budget memory budget in bytes (<= 0: unlimited)
+ */
+ControlPointCache::ControlPointCache(long long budget){
+	this->budget = budget;
+	this->bytes = 0;
+	this->peak_bytes = 0;
+	this->hits = 0;
+	this->misses = 0;
+	this->evictions = 0;
+	this->compositions = 0;
+	this->shared = 0;
+}
+
+/**
+ * Check whether the control points of a key are stored and were computed
+ * for the given generator function (a hit makes the key the most recent)
+ *
+ * @param[in] key key of the control points
+ * @param[in] genFun actual generator function
+ * @returns true if the stored control points can be used
+ */
+bool ControlPointCache::contains(vector<int> key, lst genFun){
+
+	map< vector<int>, cache_entry >::iterator it = this->entries.find(key);
+	if( it == this->entries.end() || !it->second.genFun.is_equal(genFun) ){
+		this->misses++;
+		return false;
+	}
+
+	this->lru.splice(this->lru.begin(),this->lru,it->second.lru);
+	this->hits++;
+	return true;
+}
+
+/**
+ * Store the control points of a key (replacing the previous ones) and evict
+ * the least recently used entries exceeding the budget
+ *
+ * @param[in] key key of the control points
+ * @param[in] genFun generator function the control points were computed for
+ * @param[in] syms symbols of the control points: the first num_vals get a value at evaluation, the others are parameters
+ * @param[in] num_vals number of symbols with a value
+ * @param[in] controlPts symbolic control points
+ * @param[in] affine controlPts are the constant term and the coefficients of an affine function over [0,1]^n
+ */
+void ControlPointCache::insert(vector<int> key, lst genFun, lst syms, int num_vals, lst controlPts, bool affine){
+
+	MemoryScope mem(BERNSTEIN_CACHE);
+
+	map< vector<int>, cache_entry >::iterator it = this->entries.find(key);
+	if( it != this->entries.end() ){
+		this->bytes -= it->second.bytes;
+		this->lru.erase(it->second.lru);
+		this->entries.erase(it);
+		MemoryTracker::addObjects(BERNSTEIN_CACHE,-1);
+	}
+
+	shared_ptr<compact_points> points = make_shared<compact_points>();
+	points->num_syms = syms.nops();
+	points->num_vals = num_vals;
+	points->affine = affine;
+
+	cache_entry entry;
+	entry.genFun = genFun;
+	entry.bytes = sizeof(cache_entry) + sizeof(compact_points) + key.size()*sizeof(int);
+	for (lst::const_iterator c = controlPts.begin(); c != controlPts.end(); ++c){
+		points->polys.push_back(ControlPointCache::compress(*c,syms,num_vals));
+		entry.bytes += sizeof(compact_poly) + points->polys.back().coeffs.size()*sizeof(double) + points->polys.back().exps.size();
+	}
+	entry.controlPts = points;
+
+	this->lru.push_front(key);
+	entry.lru = this->lru.begin();
+	this->bytes += entry.bytes;
+	this->peak_bytes = max(this->peak_bytes,this->bytes);
+	this->entries[key] = entry;
+	MemoryTracker::addObjects(BERNSTEIN_CACHE,1);
+
+	this->evict();
+}
+
+/**
+ * Evict the least recently used entries until the budget is met (the most
+ * recent entry is always kept)
+ */
+void ControlPointCache::evict(){
+
+	while( this->budget > 0 && this->bytes > this->budget && this->entries.size() > 1 ){
+		map< vector<int>, cache_entry >::iterator it = this->entries.find(this->lru.back());
+		this->bytes -= it->second.bytes;
+		this->entries.erase(it);
+		this->lru.pop_back();
+		this->evictions++;
+		MemoryTracker::addObjects(BERNSTEIN_CACHE,-1);
+	}
+}
+
+/**
+ * Convert a polynomial into its compact form
+ *
+ * @param[in] e polynomial in syms (affine in the symbols after the first num_vals)
+ * @param[in] syms symbols of the polynomial
+ * @param[in] num_vals number of symbols with a value
+ * @returns compact polynomial
+ */
+compact_poly ControlPointCache::compress(ex e, lst syms, int num_vals){
+
+	int n = syms.nops();
+	ex poly = e.expand();
+
+	compact_poly res;
+	int num_terms = is_a<add>(poly) ? poly.nops() : 1;
+	for(int t=0; t<num_terms; t++){
+
+		ex term = is_a<add>(poly) ? poly.op(t) : poly;
+		int para_degree = 0;
+		for(int k=0; k<n; k++){
+			int d = term.degree(syms[k]);
+			if( d < 0 || d > 255 ){
+				cout<<"ControlPointCache::compress : unsupported degree "<<d;
+				exit (EXIT_FAILURE);
+			}
+			res.exps.push_back((unsigned char)d);
+			term = term.coeff(syms[k],d);
+			if( k >= num_vals ){
+				para_degree += d;
+			}
+		}
+
+		ex coeff = evalf(term);
+		if( !is_a<numeric>(coeff) ){
+			cout<<"ControlPointCache::compress : control points must be polynomials in the given symbols";
+			exit (EXIT_FAILURE);
+		}
+		if( para_degree > 1 ){
+			cout<<"ControlPointCache::compress : control points must be affine in the parameters";
+			exit (EXIT_FAILURE);
+		}
+		res.coeffs.push_back(ex_to<numeric>(coeff).to_double());
+	}
+	return res;
+}
+
+/**
+ * Get the control points of a key (the statistics and the LRU order are not
+ * updated, use contains for the lookups)
+ *
+ * @param[in] key key of the control points
+ * @returns control points (NULL if the key is not in the cache)
+ */
+shared_ptr<const compact_points> ControlPointCache::find(vector<int> key){
+
+	map< vector<int>, cache_entry >::iterator it = this->entries.find(key);
+	if( it == this->entries.end() ){
+		return shared_ptr<const compact_points>();
+	}
+	return it->second.controlPts;
+}
+
+/**
+ * Evaluate the control points of a key
+ *
+ * @param[in] key key of the control points
+ * @param[in] values values of the first num_vals symbols
+ * @returns one row for each control point: constant term followed by the coefficients of the parameters
+ */
+vector< vector< double > > ControlPointCache::evaluate(vector<int> key, vector< double > values){
+
+	shared_ptr<const compact_points> controlPts = this->find(key);
+	if( !controlPts ){
+		cout<<"ControlPointCache::evaluate : key not in the cache";
+		exit (EXIT_FAILURE);
+	}
+	return ControlPointCache::evaluate(*controlPts,values);
+}
+
+/**
+ * Print the statistics of the cache
+ *
+ * @param[in] out output stream
+ * @param[in] name name of the cache
+ */
+void ControlPointCache::report(ostream &out, string name){
+
+	out<<"Control points cache ("<<name<<"): "<<this->entries.size()<<" entries, ";
+	out<<this->bytes/1024<<" KB (peak "<<this->peak_bytes/1024<<" KB), ";
+	out<<this->hits<<" hits, "<<this->misses<<" misses, "<<this->evictions<<" evictions, ";
+	out<<this->compositions<<" compositions ("<<this->shared<<" shared)\n";
+}
+
+/**
+ * Statistics of the cache in JSON
+ *
+ * @returns JSON object
+ */
+string ControlPointCache::toJSON(){
+
+	ostringstream json;
+	json<<"{\"entries\":"<<this->entries.size()<<",\"bytes\":"<<this->bytes<<",\"peak_bytes\":"<<this->peak_bytes;
+	json<<",\"hits\":"<<this->hits<<",\"misses\":"<<this->misses<<",\"evictions\":"<<this->evictions;
+	json<<",\"compositions\":"<<this->compositions<<",\"shared_compositions\":"<<this->shared<<"}";
+	return json.str();
+}
+
+ControlPointCache::~ControlPointCache() {
+	MemoryTracker::addObjects(BERNSTEIN_CACHE,-(long long)this->entries.size());
+}
+
+#endif
+
+/**
+ * Evaluate compact control points. Purely numerical: it can be called by
+ * several threads at once
+ *
+ * @param[in] controlPts control points
+ * @param[in] values values of the first num_vals symbols
+ * @returns one row for each control point: constant term followed by the coefficients of the parameters
+ */
+vector< vector< double > > ControlPointCache::evaluate(const compact_points &controlPts, const vector< double > &values){
+
+	if( (signed)values.size() != controlPts.num_vals ){
+		cout<<"ControlPointCache::evaluate : "<<controlPts.num_vals<<" values expected";
+		exit (EXIT_FAILURE);
+	}
+
+	int n = controlPts.num_syms;
+	vector< vector< double > > rows (controlPts.polys.size(),vector< double > (1 + n - controlPts.num_vals,0));
+	for(int i=0; i<(signed)controlPts.polys.size(); i++){
+		const compact_poly &cp = controlPts.polys[i];
+		for(int t=0; t<(signed)cp.coeffs.size(); t++){
+			const unsigned char *e = &cp.exps[t*n];
+			double v = cp.coeffs[t];
+			for(int k=0; k<controlPts.num_vals; k++){
+				for(int d=0; d<e[k]; d++){
+					v = v*values[k];
+				}
+			}
+			int pos = 0;
+			for(int k=controlPts.num_vals; k<n; k++){
+				if( e[k] > 0 ){
+					pos = 1 + k - controlPts.num_vals;
+				}
+			}
+			rows[i][pos] += v;
+		}
+	}
+	return rows;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file DenseMatrix.cpp
+ * Gauss-Jordan inversion with partial pivoting and matrix products
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "DenseMatrix.h"
+
+#include <algorithm>
+
+/**
+ * Invert a square matrix (Gauss-Jordan elimination with partial pivoting).
+ * A pivot is negligible when it is below 1e-12 times the infinity norm of M,
+ * so that the test does not depend on the scale of the matrix
+ *
+ * @param[in] M matrix to invert
+ * @param[out] inv inverse of M
+ * @returns false if M is singular
+ */
+bool DenseMatrix::invert(vector< vector< double > > M, vector< vector< double > > &inv){
+
+	int n = M.size();
+	inv = vector< vector< double > > (n,vector< double > (n,0));
+	for(int i=0; i<n; i++){
+		inv[i][i] = 1;
+	}
+
+	double norm = 0;	// infinity norm (maximum absolute row sum)
+	for(int i=0; i<n; i++){
+		double row_sum = 0;
+		for(int j=0; j<n; j++){
+			row_sum += fabs(M[i][j]);
+		}
+		norm = max(norm,row_sum);
+	}
+	double tol = 1e-12*norm;
+
+	for(int c=0; c<n; c++){
+		int pivot = c;
+		for(int r=c+1; r<n; r++){
+			if( fabs(M[r][c]) > fabs(M[pivot][c]) ){
+				pivot = r;
+			}
+		}
+		if( fabs(M[pivot][c]) <= tol ){
+			return false;
+		}
+		swap(M[c],M[pivot]);
+		swap(inv[c],inv[pivot]);
+
+		double p = M[c][c];
+		for(int k=0; k<n; k++){
+			M[c][k] = M[c][k]/p;
+			inv[c][k] = inv[c][k]/p;
+		}
+		for(int r=0; r<n; r++){
+			if( r != c && M[r][c] != 0 ){
+				double f = M[r][c];
+				for(int k=0; k<n; k++){
+					M[r][k] -= f*M[c][k];
+					inv[r][k] -= f*inv[c][k];
+				}
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Product of a matrix and a vector
+ *
+ * @param[in] M matrix
+ * @param[in] v vector
+ * @returns M v
+ */
+vector< double > DenseMatrix::mult(const vector< vector< double > > &M, const vector< double > &v){
+
+	vector< double > res (M.size(),0);
+	for(int i=0; i<(signed)M.size(); i++){
+		for(int j=0; j<(signed)v.size(); j++){
+			res[i] += M[i][j]*v[j];
+		}
+	}
+	return res;
+}
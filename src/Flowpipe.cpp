@@ -22,7 +22,9 @@ Flowpipe::Flowpipe() {
  * @param[in] flowpipe vector of bundles
  */
 Flowpipe::Flowpipe(vector< Bundle* > flowpipe){
+	MemoryScope mem(FLOWPIPE);
 	this->flowpipe = flowpipe;
+	MemoryTracker::addObjects(FLOWPIPE,flowpipe.size());
 }
 
 /**
@@ -45,7 +47,9 @@ Bundle* Flowpipe::get(int i){
  * @param[in] bundle bundle to append
  */
 void Flowpipe::append( Bundle* bundle ){
+	MemoryScope mem(FLOWPIPE);	// charge the storage, the bundles are charged to REACH_SETS by Sapo::reach
 	this->flowpipe.push_back(bundle);
+	MemoryTracker::addObjects(FLOWPIPE,1);
 }
 
 /**
@@ -127,7 +131,60 @@ void Flowpipe::plotProjToFile(int var, double time_step, char *file_name, char c
 
 }
 
+/**
+ * Store the flowpipe in binary format into a file.
+ * The file starts with the header "SAPF", the format version,
+ * the dimension, the number of directions and the direction matrix,
+ * followed by the upper and lower offsets of each step.
+ * Steps are not counted in the header so that files can be read as streams.
+ *
+ * @param[in] file_name name of the file
+ */
+void Flowpipe::saveToFile(char *file_name){
+
+	if( this->size() == 0 ){
+		cout<<"Flowpipe::saveToFile : the flowpipe must be non empty";
+		exit (EXIT_FAILURE);
+	}
+
+	ofstream out;
+	out.open (file_name, ios_base::out | ios_base::binary);
+	if( !out.is_open() ){
+		cout<<"Flowpipe::saveToFile : cannot open "<<file_name;
+		exit (EXIT_FAILURE);
+	}
+
+	int version = 1;
+	int dim = this->get(0)->getDim();
+	int num_dirs = this->get(0)->getNumDirs();
+
+	out.write("SAPF",4);
+	out.write((char*)&version,sizeof(int));
+	out.write((char*)&dim,sizeof(int));
+	out.write((char*)&num_dirs,sizeof(int));
+
+	// direction matrix (shared by all the bundles of the flowpipe)
+	vector< vector< double > > L = this->get(0)->getDirections();
+	for(int i=0; i<num_dirs; i++){
+		out.write((char*)&L[i][0],dim*sizeof(double));
+	}
+
+	// offsets of each step
+	vector< double > offp (num_dirs,0);
+	vector< double > offm (num_dirs,0);
+	for(int i=0; i<this->size(); i++){
+		for(int j=0; j<num_dirs; j++){
+			offp[j] = this->get(i)->getOffp(j);
+			offm[j] = this->get(i)->getOffm(j);
+		}
+		out.write((char*)&offp[0],num_dirs*sizeof(double));
+		out.write((char*)&offm[0],num_dirs*sizeof(double));
+	}
+
+	out.close();
+}
+
 Flowpipe::~Flowpipe() {
-	// TODO Auto-generated destructor stub
+	MemoryTracker::addObjects(FLOWPIPE,-(long long)this->flowpipe.size());
 }
 
@@ -0,0 +1,326 @@
+/**
+ * @file FlowpipeDiff.cpp
+ * Step-by-step comparison of two stored flowpipes, offset by offset on the
+ * shared directions and by support functions on the others
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "FlowpipeDiff.h"
+#include "float.h"
+#include <string.h>
+
+/**
+ * Constructor that opens the two flowpipe streams and reads their headers
+ *
+ * @param[in] ref_file file with the reference flowpipe
+ * @param[in] cand_file file with the candidate flowpipe
+ * @param[in] tol tolerance on the containment of the offsets
+ */
+FlowpipeDiff::FlowpipeDiff(char *ref_file, char *cand_file, double tol){
+
+	this->tol = tol;
+	this->truncated = false;
+
+	this->ref.open(ref_file, ios_base::in | ios_base::binary);
+	this->cand.open(cand_file, ios_base::in | ios_base::binary);
+
+	this->readHeader(this->ref, ref_file, this->ref_dirs, this->refL);
+	this->readHeader(this->cand, cand_file, this->cand_dirs, this->candL);
+
+	if( this->refL[0].size() != this->candL[0].size() ){
+		cout<<"FlowpipeDiff::FlowpipeDiff : flowpipes must have the same dimension";
+		exit (EXIT_FAILURE);
+	}
+
+	this->dim = this->refL[0].size();
+}
+
+/**
+ * Read the header of a flowpipe file
+ *
+ * @param[in] in stream to read
+ * @param[in] file_name name of the file (for error messages)
+ * @param[out] num_dirs number of directions
+ * @param[out] L direction matrix
+ */
+void FlowpipeDiff::readHeader(ifstream &in, char *file_name, int &num_dirs, vector< vector< double > > &L){
+
+	if( !in.is_open() ){
+		cout<<"FlowpipeDiff::readHeader : cannot open "<<file_name;
+		exit (EXIT_FAILURE);
+	}
+
+	char magic[4];
+	int version, dim;
+	in.read(magic,4);
+	in.read((char*)&version,sizeof(int));
+	in.read((char*)&dim,sizeof(int));
+	in.read((char*)&num_dirs,sizeof(int));
+
+	if( !in.good() || strncmp(magic,"SAPF",4) != 0 || version != 1 ){
+		cout<<"FlowpipeDiff::readHeader : "<<file_name<<" is not a flowpipe file";
+		exit (EXIT_FAILURE);
+	}
+	if( dim <= 0 || num_dirs <= 0 ){
+		cout<<"FlowpipeDiff::readHeader : "<<file_name<<" has no directions";
+		exit (EXIT_FAILURE);
+	}
+
+	vector< double > Li (dim,0);
+	L = vector< vector< double > > (num_dirs,Li);
+	for(int i=0; i<num_dirs; i++){
+		in.read((char*)&L[i][0],dim*sizeof(double));
+	}
+}
+
+/**
+ * Read the offsets of the next step of a flowpipe
+ *
+ * @param[in] in stream to read
+ * @param[in] num_dirs number of directions
+ * @param[out] offp upper offsets
+ * @param[out] offm lower offsets
+ * @returns false if the stream is over
+ */
+bool FlowpipeDiff::readStep(ifstream &in, int num_dirs, vector<double> &offp, vector<double> &offm){
+
+	if( !in.good() ){
+		return false;
+	}
+
+	in.read((char*)&offp[0],num_dirs*sizeof(double));
+	streamsize read_bytes = in.gcount();
+	if( in.good() ){
+		in.read((char*)&offm[0],num_dirs*sizeof(double));
+		read_bytes += in.gcount();
+	}
+	if( !in.good() && read_bytes > 0 ){	// the stream ends within a step
+		this->truncated = true;
+	}
+	return in.good();
+}
+
+/**
+ * Count the complete steps left in a flowpipe
+ *
+ * @param[in] in stream to read
+ * @param[in] num_dirs number of directions
+ * @returns number of steps
+ */
+int FlowpipeDiff::remainingSteps(ifstream &in, int num_dirs){
+
+	vector<double> offp (num_dirs,0), offm (num_dirs,0);
+	int steps = 0;
+	while( this->readStep(in,num_dirs,offp,offm) ){
+		steps++;
+	}
+	return steps;
+}
+
+/**
+ * Complete a report with the lengths of the flowpipes: a flowpipe with
+ * fewer (or incomplete) steps does not contain the other one
+ *
+ * @param[in,out] diff report of the compared steps
+ * @param[in] ref_over true if the reference stream is over
+ * @param[in] cand_over true if the candidate stream is over
+ */
+void FlowpipeDiff::checkLengths(flowpipe_diff &diff, bool ref_over, bool cand_over){
+
+	diff.ref_steps = diff.steps + (ref_over ? 0 : 1 + this->remainingSteps(this->ref,this->ref_dirs));
+	diff.cand_steps = diff.steps + (cand_over ? 0 : 1 + this->remainingSteps(this->cand,this->cand_dirs));
+	diff.truncated = this->truncated;
+	diff.contained = diff.first_violation < 0 && diff.ref_steps == diff.cand_steps && !diff.truncated;
+}
+
+/**
+ * Check whether the two flowpipes have the same direction matrix
+ *
+ * @returns true if the direction matrices coincide
+ */
+bool FlowpipeDiff::sameDirections(){
+
+	if( this->ref_dirs != this->cand_dirs ){
+		return false;
+	}
+
+	double epsilon = 0.00001;	// necessary for double comparison
+	for(int i=0; i<this->ref_dirs; i++){
+		for(int j=0; j<this->dim; j++){
+			if( abs(this->refL[i][j] - this->candL[i][j]) > epsilon ){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Compare the flowpipes step by step
+ *
+ * @returns comparison report
+ */
+flowpipe_diff FlowpipeDiff::compare(){
+	if( this->sameDirections() ){
+		return this->compareShared();
+	}
+	return this->compareSupport();
+}
+
+/**
+ * Compare two flowpipes with the same directions offset by offset
+ *
+ * @returns comparison report
+ */
+flowpipe_diff FlowpipeDiff::compareShared(){
+
+	int n = this->ref_dirs;
+
+	flowpipe_diff diff;
+	diff.shared_dirs = true;
+	diff.steps = 0;
+	diff.first_violation = -1;
+	diff.max_violation = -DBL_MAX;
+	diff.max_width_ratio = vector<double> (n,0);
+	diff.avg_width_ratio = vector<double> (n,0);
+
+	vector<double> refp (n,0), refm (n,0), candp (n,0), candm (n,0);
+	vector<double> ratio (n,0);
+
+	bool ref_read, cand_read;	// both streams are read at each step (no short circuit) to compare their lengths
+	while( (ref_read = this->readStep(this->ref,n,refp,refm)) & (cand_read = this->readStep(this->cand,n,candp,candm)) ){
+
+		const double *rp = &refp[0], *rm = &refm[0], *cp = &candp[0], *cm = &candm[0];
+		double *r = &ratio[0];
+		double *maxr = &diff.max_width_ratio[0], *sumr = &diff.avg_width_ratio[0];
+
+		// branch free loop over the directions
+		double step_viol = -DBL_MAX;
+		for(int j=0; j<n; j++){
+			double viol = max(rp[j] - cp[j], rm[j] - cm[j]);
+			step_viol = max(step_viol,viol);
+
+			double ref_width = rp[j] + rm[j];
+			double cand_width = cp[j] + cm[j];
+			r[j] = ref_width > 0 ? cand_width/ref_width : 1;
+			maxr[j] = max(maxr[j],r[j]);
+			sumr[j] = sumr[j] + r[j];
+		}
+
+		diff.max_violation = max(diff.max_violation,step_viol);
+		if( step_viol > this->tol && diff.first_violation < 0 ){
+			diff.first_violation = diff.steps;
+		}
+		diff.steps++;
+	}
+
+	for(int j=0; j<n && diff.steps > 0; j++){
+		diff.avg_width_ratio[j] = diff.avg_width_ratio[j]/diff.steps;
+	}
+	this->checkLengths(diff,!ref_read,!cand_read);
+
+	return diff;
+}
+
+/**
+ * Compare two flowpipes with different directions:
+ * the support function of the reference polytope along the candidate
+ * directions is computed and compared with the candidate offsets
+ *
+ * @returns comparison report
+ */
+flowpipe_diff FlowpipeDiff::compareSupport(){
+
+	int n = this->cand_dirs;
+
+	flowpipe_diff diff;
+	diff.shared_dirs = false;
+	diff.steps = 0;
+	diff.first_violation = -1;
+	diff.max_violation = -DBL_MAX;
+	diff.max_width_ratio = vector<double> (n,0);
+	diff.avg_width_ratio = vector<double> (n,0);
+
+	vector<double> refp (this->ref_dirs,0), refm (this->ref_dirs,0);
+	vector<double> candp (n,0), candm (n,0);
+
+	// constraints matrix of the reference polytope
+	vector< vector< double > > A = this->refL;
+	for(int i=0; i<this->ref_dirs; i++){
+		vector< double > minus_Li;
+		for(int j=0; j<this->dim; j++){
+			minus_Li.push_back(-this->refL[i][j]);
+		}
+		A.push_back(minus_Li);
+	}
+
+	bool ref_read, cand_read;	// both streams are read at each step (no short circuit) to compare their lengths
+	while( (ref_read = this->readStep(this->ref,this->ref_dirs,refp,refm)) & (cand_read = this->readStep(this->cand,n,candp,candm)) ){
+
+		vector< double > b = refp;
+		b.insert(b.end(),refm.begin(),refm.end());
+		LinearSystem *refLS = new LinearSystem(A,b);
+
+		double step_viol = -DBL_MAX;
+		for(int j=0; j<n; j++){
+			vector< double > minus_Lj;
+			for(int k=0; k<this->dim; k++){
+				minus_Lj.push_back(-this->candL[j][k]);
+			}
+			double supp = refLS->maxLinearSystem(this->candL[j]);
+			double suppm = refLS->maxLinearSystem(minus_Lj);
+
+			step_viol = max(step_viol,max(supp - candp[j], suppm - candm[j]));
+
+			double ref_width = supp + suppm;
+			double ratio = ref_width > 0 ? (candp[j] + candm[j])/ref_width : 1;
+			diff.max_width_ratio[j] = max(diff.max_width_ratio[j],ratio);
+			diff.avg_width_ratio[j] = diff.avg_width_ratio[j] + ratio;
+		}
+		delete refLS;
+
+		diff.max_violation = max(diff.max_violation,step_viol);
+		if( step_viol > this->tol && diff.first_violation < 0 ){
+			diff.first_violation = diff.steps;
+		}
+		diff.steps++;
+	}
+
+	for(int j=0; j<n && diff.steps > 0; j++){
+		diff.avg_width_ratio[j] = diff.avg_width_ratio[j]/diff.steps;
+	}
+	this->checkLengths(diff,!ref_read,!cand_read);
+
+	return diff;
+}
+
+/**
+ * Print a comparison report
+ *
+ * @param[in] diff report to print
+ */
+void FlowpipeDiff::print(flowpipe_diff diff){
+
+	cout<<"Compared steps: "<<diff.steps<<"\t";
+	cout<<"Directions: "<<(diff.shared_dirs ? "shared" : "support function")<<"\n";
+	if( diff.ref_steps != diff.cand_steps || diff.truncated ){
+		cout<<"Flowpipes of different lengths (reference "<<diff.ref_steps<<" steps, candidate "<<diff.cand_steps<<" steps";
+		cout<<(diff.truncated ? ", incomplete last step" : "")<<")\n";
+	}
+	if( diff.first_violation < 0 ){
+		cout<<"Reference contained in candidate (max violation "<<diff.max_violation<<")\n";
+	}else{
+		cout<<"Containment violated at step "<<diff.first_violation<<" (max violation "<<diff.max_violation<<")\n";
+	}
+	cout<<"Width ratios (direction: max avg)\n";
+	for(int j=0; j<(signed)diff.max_width_ratio.size(); j++){
+		cout<<j<<": "<<diff.max_width_ratio[j]<<" "<<diff.avg_width_ratio[j]<<"\n";
+	}
+}
+
+FlowpipeDiff::~FlowpipeDiff() {
+	this->ref.close();
+	this->cand.close();
+}
@@ -0,0 +1,328 @@
+/**
+ * @file JobScheduler.cpp
+ * Cost and memory estimates of the jobs, their history, and the
+ * fork/wait loop that runs them
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "JobScheduler.h"
+
+#include <fstream>
+#include <chrono>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+/**
+ * Constructor that instantiates the scheduler
+ *
+ * @param[in] cores available cores
+ * @param[in] mem_budget_kb available memory in KB
+ * @param[in] history_file file with the measures of the previous runs (updated by run)
+ */
+JobScheduler::JobScheduler(int cores, long mem_budget_kb, string history_file){
+	this->cores = max(1,cores);
+	this->mem_budget_kb = mem_budget_kb;
+	this->history_file = history_file;
+	this->loadHistory();
+}
+
+/**
+ * Physical memory of the machine
+ *
+ * @returns physical memory in KB
+ */
+long JobScheduler::physicalMemory(){
+	return (long)(sysconf(_SC_PHYS_PAGES) / 1024 * sysconf(_SC_PAGE_SIZE));
+}
+
+/**
+ * Add a job
+ *
+ * @param[in] name name of the job (key in the history, no spaces)
+ * @param[in] model model to analyze
+ * @param[in] steps time horizon (synthesis: 0 for the horizon of the specification)
+ * @param[in] synthesis parameter synthesis (otherwise reachability)
+ * @param[in] options options of the analysis
+ * @param[in] threads thread quota
+ */
+void JobScheduler::add(string name, Model *model, int steps, bool synthesis, sapo_opt options, int threads){
+
+	sapo_job job;
+	job.name = name;
+	job.model = model;
+	job.steps = steps;
+	job.synthesis = synthesis;
+	job.options = options;
+	job.threads = min(max(1,threads),this->cores);
+	job.cost = 0;
+	job.mem_kb = 0;
+
+	this->jobs.push_back(job);
+}
+
+/**
+ * Load the measures of the previous runs (one "name time peak_rss_kb" line per job)
+ */
+void JobScheduler::loadHistory(){
+
+	ifstream in(this->history_file.c_str());
+	string name;
+	job_record record;
+	while( in>>name>>record.time>>record.peak_rss_kb ){
+		this->history[name] = record;
+	}
+}
+
+/**
+ * Store the measures of all the runs
+ */
+void JobScheduler::saveHistory(){
+
+	ofstream out(this->history_file.c_str());
+	for(map< string, job_record >::iterator it = this->history.begin(); it != this->history.end(); ++it){
+		out<<it->first<<" "<<it->second.time<<" "<<it->second.peak_rss_kb<<"\n";
+	}
+	out.close();
+}
+
+/**
+ * Total degree of the dynamics
+ *
+ * @param[in] vars variables of the dynamics
+ * @param[in] dyns dynamics
+ * @returns maximum total degree
+ */
+int JobScheduler::totalDegree(lst vars, lst dyns){
+
+	symbol t("t");
+	lst sub;
+	for(int i=0; i<(signed)vars.nops(); i++){
+		sub.append(vars[i] == t*vars[i]);
+	}
+
+	int degree = 1;
+	for(int i=0; i<(signed)dyns.nops(); i++){
+		degree = max(degree,dyns[i].subs(sub).expand().degree(t));
+	}
+	return degree;
+}
+
+/**
+ * Total degree of the dynamics of a model (of all the modes if piecewise)
+ *
+ * @param[in] model model of the job
+ * @returns maximum total degree
+ */
+int JobScheduler::totalDegree(Model *model){
+
+	int degree = this->totalDegree(model->getVars(),model->getDyns());
+	vector< lst > modeDyns = model->getModeDyns();
+	for(int m=0; m<(signed)modeDyns.size(); m++){
+		degree = max(degree,this->totalDegree(model->getVars(),modeDyns[m]));
+	}
+	return degree;
+}
+
+/**
+ * Model-based cost: number of Bernstein coefficients evaluated along the horizon
+ *
+ * @param[in] job job to estimate
+ * @returns cost in abstract units
+ */
+double JobScheduler::modelCost(sapo_job &job){
+
+	Bundle *B = job.model->getReachSet();
+	int dim = job.model->getVars().nops();
+	int degree = this->totalDegree(job.model);
+	int dirs = job.options.trans ? B->getSize() : dim;
+	int steps = job.steps;
+	if( job.synthesis && steps == 0 ){
+		steps = job.model->getSpec()->getB();
+	}
+
+	double coeffs = 1;		// Bernstein coefficients of a polynomial in dim variables
+	for(int i=0; i<dim; i++){
+		coeffs = coeffs*(degree + 1);
+	}
+	double cost = (double)steps * B->getCard() * dirs * coeffs;
+	if( job.synthesis ){		// one LP for each coefficient and parameter set
+		cost = cost * 10 * (1 + job.model->getParams().nops());
+	}
+	return cost;
+}
+
+/**
+ * Model-based memory: control points cache, flowpipe, and a base footprint
+ *
+ * @param[in] job job to estimate
+ * @returns peak memory in KB
+ */
+long JobScheduler::modelMemory(sapo_job &job){
+
+	Bundle *B = job.model->getReachSet();
+	int dim = job.model->getVars().nops();
+	int degree = this->totalDegree(job.model);
+
+	double coeffs = 1;
+	for(int i=0; i<dim; i++){
+		coeffs = coeffs*(degree + 1);
+	}
+	double cache_kb = B->getCard() * B->getSize() * coeffs * 0.5;	// ~0.5 KB per symbolic coefficient
+	double flowpipe_kb = job.steps * B->getSize() * 0.2;
+	return (long)(20000 + cache_kb + flowpipe_kb);
+}
+
+/**
+ * Estimate cost and memory of the jobs. The jobs with a history take its
+ * measures, the others scale their model-based cost by the seconds per unit
+ * observed on the jobs with a history
+ */
+void JobScheduler::estimate(){
+
+	double hist_time = 0, hist_units = 0;
+	vector<double> units (this->jobs.size());
+
+	for(int i=0; i<(signed)this->jobs.size(); i++){
+		units[i] = this->modelCost(this->jobs[i]);
+		if( this->history.count(this->jobs[i].name) > 0 ){
+			hist_time += this->history[this->jobs[i].name].time;
+			hist_units += units[i];
+		}
+	}
+	double secs_per_unit = hist_units > 0 ? hist_time / hist_units : 0.00001;
+
+	for(int i=0; i<(signed)this->jobs.size(); i++){
+		sapo_job &job = this->jobs[i];
+		if( this->history.count(job.name) > 0 ){
+			job.cost = this->history[job.name].time;
+			job.mem_kb = this->history[job.name].peak_rss_kb;
+		}else{
+			job.cost = units[i]*secs_per_unit;
+			job.mem_kb = this->modelMemory(job);
+		}
+	}
+}
+
+/**
+ * Execute a job (in the child process)
+ *
+ * @param[in] job job to execute
+ */
+void JobScheduler::execute(sapo_job &job){
+
+	if( freopen("/dev/null","w",stdout) == NULL ){		// keep the output of the scheduler readable
+		exit(EXIT_FAILURE);
+	}
+
+	sapo_opt options = job.options;
+	options.threads = job.threads;
+	Sapo *sapo = new Sapo(job.model,options);
+	Model *model = job.model;
+
+	if( job.synthesis ){
+		sapo->synthesize(model->getReachSet(),model->getParaSet(),model->getSpec());
+	}else if( model->getParams().nops() > 0 ){
+		sapo->reach(model->getReachSet(),model->getParaSet()->at(0),job.steps);
+	}else{
+		sapo->reach(model->getReachSet(),job.steps);
+	}
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * Run all the jobs: the longest job that fits the free cores and memory is
+ * started first, a job that does not fit the memory budget runs alone
+ *
+ * @returns makespan (seconds)
+ */
+double JobScheduler::run(){
+
+	this->estimate();
+
+	vector< pair<double,int> > order;
+	for(int i=0; i<(signed)this->jobs.size(); i++){
+		order.push_back(pair<double,int> (-this->jobs[i].cost,i));
+	}
+	sort(order.begin(),order.end());
+
+	typedef chrono::steady_clock clk;
+	clk::time_point tStart = clk::now();
+	vector<clk::time_point> started (this->jobs.size());
+	vector<bool> launched (this->jobs.size(),false);
+	map<pid_t,int> running;
+	int free_cores = this->cores;
+	long free_mem = this->mem_budget_kb;
+	int completed = 0;
+
+	while( completed < (signed)this->jobs.size() ){
+
+		// start the longest jobs that fit
+		for(int k=0; k<(signed)order.size(); k++){
+			int i = order[k].second;
+			sapo_job &job = this->jobs[i];
+			if( launched[i] || !(running.empty() || (job.threads <= free_cores && job.mem_kb <= free_mem)) ){
+				continue;
+			}
+
+			cout.flush();
+			ThreadPool::stopShared();	// the child starts its own pool
+			pid_t pid = fork();
+			if( pid < 0 ){
+				cout<<"JobScheduler::run : cannot fork";
+				exit (EXIT_FAILURE);
+			}
+			if( pid == 0 ){
+				this->execute(job);
+			}
+
+			cout<<"Job "<<job.name<<" started\t(estimated "<<job.cost<<" s, "<<job.mem_kb<<" KB, "<<job.threads<<" threads)\n";
+			running[pid] = i;
+			launched[i] = true;
+			started[i] = clk::now();
+			free_cores -= job.threads;
+			free_mem -= job.mem_kb;
+		}
+
+		// wait for a job to complete
+		int status;
+		struct rusage usage;
+		pid_t pid = wait4(-1,&status,0,&usage);
+		if( pid < 0 ){
+			cout<<"JobScheduler::run : no running job";
+			exit (EXIT_FAILURE);
+		}
+		if( running.count(pid) == 0 ){
+			continue;
+		}
+
+		int i = running[pid];
+		running.erase(pid);
+		sapo_job &job = this->jobs[i];
+		free_cores += job.threads;
+		free_mem += job.mem_kb;
+		completed++;
+
+		job_record record;
+		record.time = chrono::duration<double>(clk::now() - started[i]).count();
+		record.peak_rss_kb = usage.ru_maxrss;
+#ifdef __APPLE__
+		record.peak_rss_kb = record.peak_rss_kb / 1024;		// bytes on macOS
+#endif
+
+		if( WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS ){
+			this->history[job.name] = record;
+			cout<<"Job "<<job.name<<" done\tTime taken: "<<record.time<<" s, peak memory: "<<record.peak_rss_kb<<" KB\n";
+		}else{
+			cout<<"Job "<<job.name<<" failed\n";
+		}
+	}
+
+	double makespan = chrono::duration<double>(clk::now() - tStart).count();
+	cout<<"Makespan: "<<makespan<<" s on "<<this->cores<<" cores\n";
+
+	this->saveHistory();
+	return makespan;
+}
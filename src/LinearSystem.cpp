@@ -18,33 +18,19 @@
  */
 LinearSystem::LinearSystem(vector< vector<double> > A, vector< double > b){
 
-	bool smart_insert = false;
-
-	if(!smart_insert){
-		this->A = A;
-		this->b = b;
-	}else{
-		for(int i=0; i<(signed)A.size(); i++){
-			if(!this->isIn(A[i],b[i]) && (!this->zeroLine(A[i]))){
-				this->A.push_back(A[i]);
-				this->b.push_back(b[i]);
-			}
-		}
-
-	}
-	this->n_vars = this->A[0].size();
+	this->n_vars = A[0].size();
+	this->n_rows = b.size();
+	this->blocks.push_back(make_shared<const constraint_block>(A,b));
+	this->materialized = false;
 }
 
 /**
  * Constructor that instantiates an empty linear system
  */
 LinearSystem::LinearSystem(){
-	vector< vector<double> > A;
-	vector< double > b;
-	this->A = A;
-	this->b = b;
 	this->n_vars = 0;
-
+	this->n_rows = 0;
+	this->materialized = true;
 }
 
 /**
@@ -55,16 +41,70 @@ LinearSystem::LinearSystem(){
  * @returns true is Ai x <= b is in the linear system
  */
 bool LinearSystem::isIn(vector< double > Ai, double bi){
+	return LinearSystem::isIn(this->A,this->b,Ai,bi);
+}
+
+/**
+ * Copy constructor: the blocks and the clipped polytope are immutable and
+ * shared, the materialized rows are copied
+ *
+ * @param[in] LS linear system to copy
+ */
+LinearSystem::LinearSystem(const LinearSystem &LS){
+
+	lock_guard<mutex> guard(LS.lazy_lock);
+	this->n_vars = LS.n_vars;
+	this->n_rows = LS.n_rows;
+	this->vars = LS.vars;
+	this->constraints = LS.constraints;
+	this->blocks = LS.blocks;
+	this->A = LS.A;
+	this->b = LS.b;
+	this->materialized = (bool)LS.materialized;
+	this->low_dim = LS.low_dim;
+}
+
+/**
+ * Assignment with the semantics of the copy constructor
+ *
+ * @param[in] LS linear system to copy
+ * @return this linear system
+ */
+LinearSystem& LinearSystem::operator=(const LinearSystem &LS){
+
+	if( this != &LS ){
+		lock(this->lazy_lock,LS.lazy_lock);
+		lock_guard<mutex> guard(this->lazy_lock,adopt_lock);
+		lock_guard<mutex> guard_LS(LS.lazy_lock,adopt_lock);
+		this->n_vars = LS.n_vars;
+		this->n_rows = LS.n_rows;
+		this->vars = LS.vars;
+		this->constraints = LS.constraints;
+		this->blocks = LS.blocks;
+		this->A = LS.A;
+		this->b = LS.b;
+		this->materialized = (bool)LS.materialized;
+		this->low_dim = LS.low_dim;
+	}
+	return *this;
+}
+
+/**
+ * Check if a constraint belongs to a set of rows
+ *
+ * @param[in] A template matrix of the rows
+ * @param[in] b offset vector of the rows
+ * @param[in] Ai direction
+ * @param[in] bi offset
+ * @return true if Ai x <= bi is one of the rows (up to 1e-5)
+ */
+bool LinearSystem::isIn(const vector< vector<double> > &A, const vector< double > &b, const vector< double > &Ai, double bi){
 
 	double epsilon = 0.00001;	// necessary for double comparison
-	Ai.push_back(bi);
-
-	for( int i=0; i<(signed)this->A.size(); i++ ){
-		vector< double > line = this->A[i];
-		line.push_back(this->b[i]);
-		bool is_in = true;
-		for(int j=0; j<(signed)Ai.size(); j++){
-			is_in = is_in && (abs(Ai[j] - line[j]) < epsilon);
+	for( int i=0; i<(signed)A.size(); i++ ){
+		bool is_in = abs(bi - b[i]) < epsilon;
+		for(int j=0; j<(signed)Ai.size() && is_in; j++){
+			is_in = abs(Ai[j] - A[i][j]) < epsilon;
 		}
 		if(is_in){ return true; }
 	}
@@ -86,6 +126,32 @@ LinearSystem::LinearSystem(lst vars, lst constraints) {
 	this->n_vars = this->vars.nops();
 
 	initLS();	// initialize Linear System
+
+	this->n_rows = this->b.size();
+	this->blocks.push_back(make_shared<const constraint_block>(this->A,this->b));
+	this->A.clear();
+	this->b.clear();
+	this->materialized = false;
+}
+
+/**
+ * Copy the rows of the blocks in A and b, the first time they are needed
+ * contiguously
+ */
+void LinearSystem::materialize(){
+
+	if( this->materialized ){
+		return;
+	}
+
+	lock_guard<mutex> guard(this->lazy_lock);
+	if( !this->materialized ){
+		for(int k=0; k<(signed)this->blocks.size(); k++){
+			this->A.insert(this->A.end(),this->blocks[k]->A.begin(),this->blocks[k]->A.end());
+			this->b.insert(this->b.end(),this->blocks[k]->b.begin(),this->blocks[k]->b.end());
+		}
+		this->materialized = true;
+	}
 }
 
 /**
@@ -124,6 +190,7 @@ void LinearSystem::initLS(){
  * @return template matrix
  */
 vector< vector<double> > LinearSystem::getA(){
+	this->materialize();
 	return this->A;
 }
 
@@ -133,6 +200,7 @@ vector< vector<double> > LinearSystem::getA(){
  * @return offset vector
  */
 vector<double> LinearSystem::getb(){
+	this->materialize();
 	return this->b;
 }
 
@@ -144,6 +212,7 @@ vector<double> LinearSystem::getb(){
  * @return (i,j) element
  */
 double LinearSystem::getA(int i, int j){
+	this->materialize();
 	if(( 0<= i ) && (i < (signed)this->A.size())){
 		if(( 0<= j ) && (j < (signed)this->A[j].size())){
 			return this->A[i][j];
@@ -160,6 +229,7 @@ double LinearSystem::getA(int i, int j){
  * @return i-th element
  */
 double LinearSystem::getb(int i){
+	this->materialize();
 	if(( 0<= i ) && (i < (signed)this->b.size())){
 			return this->b[i];
 	}
@@ -169,47 +239,110 @@ double LinearSystem::getb(int i){
 
 /**
  * Determine whether this linear system is empty or not, i.e.,
- * the linear system has solutions
+ * the linear system has solutions. In dimension at most 3, a bounded
+ * clipped polytope with a non-negligible volume proves the non-emptiness;
+ * all the other cases are decided by the LP
  *
  * @return true if the linear system is empty
  */
 bool LinearSystem::isEmpty(){
 
-	vector< vector< double > > extA = this->A;
+	LowDimPolytope *P = this->lowDim();
+	if( P != NULL && P->isBounded() && !P->isEmpty() ){
+		return false;
+	}
+
+	// Add an extra variable to the linear system
 	vector< double > obj_fun (this->n_vars, 0);
 	obj_fun.push_back(1);
 
-	// Add an extra variable to the linear system
-	for(int i=0; i<(signed)extA.size(); i++){
-		extA[i].push_back(-1);
+	double z = this->solveLinearSystem(obj_fun,GLP_MIN,true);
+
+	return (z>=0);
+
+}
+
+/**
+ * Get the clipped polytope of the linear system, built at the first call
+ *
+ * @return clipped polytope (NULL if the dimension is larger than 3)
+ */
+LowDimPolytope* LinearSystem::lowDim(){
+
+	if( this->n_rows == 0 || this->n_vars < 1 || this->n_vars > 3 ){
+		return NULL;
 	}
 
-	double z = this->solveLinearSystem(extA,this->b,obj_fun,GLP_MIN);
+	lock_guard<mutex> guard(this->lazy_lock);
+	if( !this->low_dim ){
+		if( this->blocks.size() == 1 ){		// no need to materialize the rows
+			this->low_dim = shared_ptr<LowDimPolytope> (new LowDimPolytope(this->blocks[0]->A,this->blocks[0]->b));
+		}else{
+			vector< vector<double> > A;
+			vector< double > b;
+			for(int k=0; k<(signed)this->blocks.size(); k++){
+				A.insert(A.end(),this->blocks[k]->A.begin(),this->blocks[k]->A.end());
+				b.insert(b.end(),this->blocks[k]->b.begin(),this->blocks[k]->b.end());
+			}
+			this->low_dim = shared_ptr<LowDimPolytope> (new LowDimPolytope(A,b));
+		}
+	}
+	return this->low_dim.get();
+}
 
-	return (z>=0);
+/**
+ * Optimize the linear system, directly on the vertices when the polytope
+ * is bounded and has dimension at most 3 (the optimum is then rounded
+ * outward by the clipping tolerance), by LP otherwise
+ *
+ * @param[in] obj_fun objective function
+ * @param[in] min_max minimize of maximize Ax<=b (GLP_MIN=min, GLP_MAX=max)
+ * @return optimum
+ */
+double LinearSystem::optimize(vector< double > obj_fun, int min_max){
 
+	LowDimPolytope *P = this->lowDim();
+	if( P != NULL && P->isBounded() && !P->isEmpty() ){
+		if( min_max == GLP_MAX ){
+			return P->support(obj_fun);
+		}
+		for(int i=0; i<(signed)obj_fun.size(); i++){
+			obj_fun[i] = -obj_fun[i];
+		}
+		return -P->support(obj_fun);
+	}
+	return this->solveLinearSystem(obj_fun,min_max,false);
 }
 
 /**
- * Optimize a linear system
+ * Optimize the linear system, loading the rows directly from the blocks
  *
- * @param[in] A template matrix of the system to optimize
- * @param[in] b offset vector of the system to optimize
  * @param[in] obj_fun objective function
  * @param[in] min_max minimize of maximize Ax<=b (GLP_MIN=min, GLP_MAX=max)
+ * @param[in] slack add the variable t to each row, A x - t <= b (last entry of obj_fun)
  * @return optimum
  */
-double LinearSystem::solveLinearSystem(vector< vector< double > > A, vector< double > b, vector< double > obj_fun, int min_max){
+double LinearSystem::solveLinearSystem(vector< double > obj_fun, int min_max, bool slack){
 
-	int num_rows = A.size();
+	PerfScope perf(LP_PHASE);
+	MemoryScope mem(LP);
+
+	int num_rows = this->n_rows;
 	int num_cols = obj_fun.size();
 	int size_lp = num_rows*num_cols;
 
-	int ia[size_lp+1], ja[size_lp+1];
-	double ar[size_lp+1];
+	// each thread reuses its own problem and index arrays
+	static thread_local lp_workspace ws;
+	if( ws.lp == NULL ){
+		ws.lp = glp_create_prob();
+	}else{
+		glp_erase_prob(ws.lp);
+	}
+	ws.ia.resize(size_lp+1);
+	ws.ja.resize(size_lp+1);
+	ws.ar.resize(size_lp+1);
 
-	glp_prob *lp;
-	lp = glp_create_prob();
+	glp_prob *lp = ws.lp;
 	glp_set_obj_dir(lp, min_max);
 
 	// Turn off verbose mode
@@ -218,8 +351,12 @@ double LinearSystem::solveLinearSystem(vector< vector< double > > A, vector< dou
 	lp_param.msg_lev = GLP_MSG_ERR;
 
 	glp_add_rows(lp, num_rows);
-	for(int i=0; i<num_rows; i++){
-		glp_set_row_bnds(lp, i+1, GLP_UP, 0.0, b[i]);
+	int i=0;
+	for(int blk=0; blk<(signed)this->blocks.size(); blk++){
+		const vector< double > &b = this->blocks[blk]->b;
+		for(int r=0; r<(signed)b.size(); r++, i++){
+			glp_set_row_bnds(lp, i+1, GLP_UP, 0.0, b[r]);
+		}
 	}
 
 	glp_add_cols(lp, num_cols);
@@ -232,20 +369,27 @@ double LinearSystem::solveLinearSystem(vector< vector< double > > A, vector< dou
 	}
 
 	int k=1;
-	for(int i=0; i<num_rows; i++){
-		for(int j=0; j<num_cols; j++){
-			ia[k] = i+1, ja[k] = j+1, ar[k] = A[i][j]; /* a[i+1,j+1] = A[i][j] */
-			k++;
+	i=0;
+	for(int blk=0; blk<(signed)this->blocks.size(); blk++){
+		const vector< vector< double > > &A = this->blocks[blk]->A;
+		for(int r=0; r<(signed)A.size(); r++, i++){
+			for(int j=0; j<this->n_vars; j++){
+				if( A[r][j] != 0 ){		// load only the non-zero elements
+					ws.ia[k] = i+1, ws.ja[k] = j+1, ws.ar[k] = A[r][j]; /* a[i+1,j+1] = A[r][j] */
+					k++;
+				}
+			}
+			if( slack ){
+				ws.ia[k] = i+1, ws.ja[k] = num_cols, ws.ar[k] = -1;
+				k++;
+			}
 		}
 	}
 
-	glp_load_matrix(lp, size_lp, ia, ja, ar);
+	glp_load_matrix(lp, k-1, &ws.ia[0], &ws.ja[0], &ws.ar[0]);
 	glp_simplex(lp, &lp_param);
 
-	double res = glp_get_obj_val(lp);
-	glp_delete_prob(lp);
-	glp_free_env();
-	return res;
+	return glp_get_obj_val(lp);
 
 }
 
@@ -272,7 +416,7 @@ double LinearSystem::minLinearSystem(lst vars, ex obj_fun){
 	}
 
 	double c = ex_to<numeric>(evalf(const_term)).to_double();
-	double min = this->solveLinearSystem(this->A,this->b,obj_fun_coeffs,GLP_MIN);
+	double min = this->optimize(obj_fun_coeffs,GLP_MIN);
 
 	return (min+c);
 
@@ -285,7 +429,7 @@ double LinearSystem::minLinearSystem(lst vars, ex obj_fun){
  * @return maximum
  */
 double LinearSystem::maxLinearSystem(vector< double > obj_fun_coeffs){
-	return this->solveLinearSystem(this->A,this->b,obj_fun_coeffs,GLP_MAX);
+	return this->optimize(obj_fun_coeffs,GLP_MAX);
 }
 
 /**
@@ -310,33 +454,183 @@ double LinearSystem::maxLinearSystem(lst vars, ex obj_fun){
 	}
 
 	double c = ex_to<numeric>(evalf(const_term)).to_double();
-	double max = this->solveLinearSystem(this->A,this->b,obj_fun_coeffs,GLP_MAX);
+	double max = this->optimize(obj_fun_coeffs,GLP_MAX);
 
 	return (max+c);
 }
 
 /**
- * Create a new liner system by merging this LS and the specified one
+ * Blocked kernel of the batch queries: update the maximum violation of the
+ * points first,...,last-1 with the rows lb_i <= A_i x <= ub_i. The points
+ * are transposed in blocks of 8 so that the products of a row with a block
+ * run on contiguous lanes the compiler can vectorize
+ *
+ * @param[in] A rows
+ * @param[in] ub upper bounds of the rows
+ * @param[in] lb lower bounds of the rows (empty: none)
+ * @param[in] points points to test
+ * @param[in] first first point
+ * @param[in] last point after the last one
+ * @param[in,out] viol maximum violation of each point (updated)
+ */
+void LinearSystem::batchViolations(const vector< vector<double> > &A, const vector<double> &ub, const vector<double> &lb,
+		const vector< vector<double> > &points, int first, int last, double *viol){
+
+	const int W = 8;	// points per block
+	if( A.empty() ){
+		return;
+	}
+	int dim = A[0].size();
+	vector<double> X (dim*W);
+	double acc[W], worst[W];
+
+	for(int p0=first; p0<last; p0+=W){
+
+		int w = min(W,last-p0);
+		for(int k=0; k<dim; k++){		// transpose the block
+			for(int l=0; l<W; l++){
+				X[k*W+l] = l < w ? points[p0+l][k] : 0;
+			}
+		}
+		for(int l=0; l<W; l++){
+			worst[l] = l < w ? viol[p0+l] : 0;
+		}
+
+		for(int i=0; i<(signed)A.size(); i++){
+			for(int l=0; l<W; l++){
+				acc[l] = 0;
+			}
+			for(int k=0; k<dim; k++){
+				double a = A[i][k];
+				if( a != 0 ){
+					const double *x = &X[k*W];
+					for(int l=0; l<W; l++){
+						acc[l] += a*x[l];
+					}
+				}
+			}
+			for(int l=0; l<W; l++){
+				worst[l] = max(worst[l],acc[l] - ub[i]);
+			}
+			if( !lb.empty() ){
+				for(int l=0; l<W; l++){
+					worst[l] = max(worst[l],lb[i] - acc[l]);
+				}
+			}
+		}
+
+		for(int l=0; l<w; l++){
+			viol[p0+l] = worst[l];
+		}
+	}
+}
+
+/**
+ * Signed violation of many points: max_i A_i x - b_i (non-positive inside
+ * the polytope). The rows are read from the blocks and the points are split
+ * in chunks among the threads
+ *
+ * @param[in] points points to test
+ * @return maximum violation of each point
+ */
+vector<double> LinearSystem::violations(const vector< vector<double> > &points){
+
+	const int chunk = 4096;
+	int n = points.size();
+	vector<double> viol (n,-HUGE_VAL);
+
+	for(int p=0; p<n && this->n_rows > 0; p++){
+		if( (signed)points[p].size() != this->n_vars ){
+			cout<<"LinearSystem::violations : the points must have "<<this->n_vars<<" coordinates";
+			exit (EXIT_FAILURE);
+		}
+	}
+
+	ThreadPool::shared()->parallelFor((n + chunk - 1)/chunk,[&](int c){
+		vector<double> none;
+		for(int k=0; k<(signed)this->blocks.size(); k++){
+			batchViolations(this->blocks[k]->A,this->blocks[k]->b,none,points,c*chunk,min(n,(c+1)*chunk),&viol[0]);
+		}
+	});
+	return viol;
+}
+
+/**
+ * Membership of many points
+ *
+ * @param[in] points points to test
+ * @param[in] tol tolerance on the violations
+ * @return true for the points with A x <= b + tol
+ */
+vector<bool> LinearSystem::contains(const vector< vector<double> > &points, double tol){
+	return LinearSystem::contains(this->violations(points),tol);
+}
+
+/**
+ * Membership of points from their signed violations (shared by the sets
+ * that compute their own violations, e.g., bundles and unions)
+ *
+ * @param[in] viol violation of each point
+ * @param[in] tol tolerance on the violations
+ * @return true for the points with violation <= tol
+ */
+vector<bool> LinearSystem::contains(const vector<double> &viol, double tol){
+
+	vector<bool> in (viol.size());
+	for(int i=0; i<(signed)viol.size(); i++){
+		in[i] = viol[i] <= tol;
+	}
+	return in;
+}
+
+/**
+ * Create a new liner system by merging this LS and the specified one.
+ * The blocks of constraints are shared, not copied: the blocks already in
+ * this LS are skipped, and so are the rows already in the merged system
+ * (compared by content, so that systems built separately with the same
+ * constraints do not grow at each merge)
  *
  * @param[in] LS linear system to be appended
  * @return linear system obtained by merge
  */
 LinearSystem* LinearSystem::appendLinearSystem(LinearSystem *LS){
 
-	vector< vector<double> > newA = this->A;
-	vector<double> newb = this->b;
+	LinearSystem *res = new LinearSystem();
+	res->n_vars = max(this->n_vars,LS->n_vars);
+	res->blocks = this->blocks;
+	res->n_rows = this->n_rows;
+
+	for(int k=0; k<(signed)LS->blocks.size(); k++){
 
-	vector< vector<double> > LSA = LS->getA();
-	vector<double> LSb = LS->getb();
+		if( find(res->blocks.begin(),res->blocks.end(),LS->blocks[k]) != res->blocks.end() ){	// shared block
+			continue;
+		}
 
-	for(int i=0; i<LS->size(); i++){
-		if( !this->isIn(LSA[i],LSb[i]) ){		// check for duplicates
-			newA.push_back( LSA[i] );
-			newb.push_back( LSb[i] );
+		// rows of the block that are not in the merged system yet
+		const constraint_block &block = *LS->blocks[k];
+		vector< vector<double> > new_A;
+		vector< double > new_b;
+		for(int r=0; r<(signed)block.b.size(); r++){
+			bool is_in = LinearSystem::isIn(new_A,new_b,block.A[r],block.b[r]);
+			for(int j=0; j<(signed)res->blocks.size() && !is_in; j++){
+				is_in = LinearSystem::isIn(res->blocks[j]->A,res->blocks[j]->b,block.A[r],block.b[r]);
+			}
+			if( !is_in ){
+				new_A.push_back(block.A[r]);
+				new_b.push_back(block.b[r]);
+			}
 		}
+
+		if( new_b.size() == block.b.size() ){	// all new: share the block
+			res->blocks.push_back(LS->blocks[k]);
+		}else if( !new_b.empty() ){
+			res->blocks.push_back(make_shared<const constraint_block>(new_A,new_b));
+		}
+		res->n_rows += new_b.size();
 	}
+	res->materialized = res->blocks.empty();
 
-	return new LinearSystem(newA,newb);
+	return res;
 
 }
 
@@ -346,6 +640,7 @@ LinearSystem* LinearSystem::appendLinearSystem(LinearSystem *LS){
  * @return boolean vector (true is if i-th constrain is redundant)
  */
 vector<bool> LinearSystem::redundantCons(){
+	this->materialize();
 
 	vector<bool> redun (this->size(), false);
 
@@ -358,6 +653,30 @@ vector<bool> LinearSystem::redundantCons(){
 	return redun;
 }
 
+/**
+ * Determine the bounding box of the linear system (the LPs of the faces are
+ * solved in parallel)
+ *
+ * @param[out] lb lower bounds of the variables
+ * @param[out] ub upper bounds of the variables
+ */
+void LinearSystem::boundingBox(vector<double> &lb, vector<double> &ub){
+
+	int n = this->n_vars;
+	lb = vector<double> (n);
+	ub = vector<double> (n);
+
+	ThreadPool::shared()->parallelFor(2*n,[&](int k){
+		vector<double> facet (n,0);
+		facet[k/2] = 1;
+		if( k % 2 == 0 ){
+			ub[k/2] = this->optimize(facet,GLP_MAX);
+		}else{
+			lb[k/2] = this->optimize(facet,GLP_MIN);
+		}
+	});
+}
+
 /**
  * Determine the volume of the bounding box of the linear system
  *
@@ -371,9 +690,9 @@ double LinearSystem::volBoundingBox(){
 	for(int i=0; i<this->dim(); i++){
 		vector<double> facet = zeros;
 		facet[i] = 1;
-		double b_plus = this->solveLinearSystem(this->A,this->b,facet,GLP_MAX);
+		double b_plus = this->optimize(facet,GLP_MAX);
 		facet[i] = -1;
-		double b_minus = this->solveLinearSystem(this->A,this->b,facet,GLP_MAX);
+		double b_minus = this->optimize(facet,GLP_MAX);
 		vol = vol*(b_plus+b_minus);
 	}
 
@@ -381,6 +700,42 @@ double LinearSystem::volBoundingBox(){
 }
 
 
+/**
+ * Determine the volume of the linear system (dimension at most 3)
+ *
+ * @return volume
+ */
+double LinearSystem::volume(){
+
+	LowDimPolytope *P = this->lowDim();
+	if( P != NULL && !P->isBounded() && this->isEmpty() ){
+		return 0;
+	}
+	if( P == NULL || !P->isBounded() ){
+		cout<<"LinearSystem::volume : the linear system must be bounded and of dimension at most 3";
+		exit (EXIT_FAILURE);
+	}
+	return P->volume();
+}
+
+/**
+ * Determine the vertices of the linear system (dimension at most 3)
+ *
+ * @return vertices
+ */
+vector< vector<double> > LinearSystem::vertices(){
+
+	LowDimPolytope *P = this->lowDim();
+	if( P != NULL && !P->isBounded() && this->isEmpty() ){
+		return vector< vector<double> > ();
+	}
+	if( P == NULL || !P->isBounded() ){
+		cout<<"LinearSystem::vertices : the linear system must be bounded and of dimension at most 3";
+		exit (EXIT_FAILURE);
+	}
+	return P->getVertices();
+}
+
 /**
  * Check if if a vector is null, i.e.,
  * it's a vector of zeros (used to detected useless constraints)
@@ -406,6 +761,7 @@ bool LinearSystem::zeroLine(vector<double> line){
  * Print the linear system
  */
 void LinearSystem::print(){
+	this->materialize();
 	for(int i=0; i<(signed)this->A.size(); i++){
 		for(int j=0; j<(signed)this->A[i].size(); j++){
 			cout<<this->A[i][j]<<" ";
@@ -419,6 +775,7 @@ void LinearSystem::print(){
  * Print the linear system in Matlab format (for plotregion script)
  */
 void LinearSystem::plotRegion(){
+	this->materialize();
 
 	if(this->dim() > 3){
 		cout<<"LinearSystem::plotRegion : maximum 3d sets are allowed";
@@ -444,6 +801,7 @@ void LinearSystem::plotRegion(){
  * @param[in] color color of the polytope to plot
  */
 void LinearSystem::plotRegionToFile(char *file_name, char color){
+	this->materialize();
 
 	if(this->dim() > 3){
 		cout<<"LinearSystem::plotRegion : maximum 3d sets are allowed";
@@ -477,6 +835,7 @@ void LinearSystem::plotRegionT(double t){
 		cout<<"LinearSystem::plotRegionT : maximum 2d sets are allowed";
 		exit (EXIT_FAILURE);
 	}
+	this->materialize();
 
 	cout<<"Ab = [\n";
 	cout<<" 1 ";
@@ -515,6 +874,7 @@ void LinearSystem::plotRegion(vector<int> rows, vector<int> cols){
 			cout<<"LinearSystem::plotRegion : cols maximum 3d sets are allowed";
 			exit (EXIT_FAILURE);
 		}
+		this->materialize();
 
 		cout<<"Ab = [\n";
 		for(int i=0; i<(signed)rows.size(); i++){
@@ -23,6 +23,7 @@ LinearSystemSet::LinearSystemSet(){
 LinearSystemSet::LinearSystemSet(LinearSystem *LS){
 	if(!LS->isEmpty()){
 		this->set.push_back(LS);
+		MemoryTracker::addObjects(SYNTHESIS_SETS,1);
 	}
 }
 
@@ -36,6 +37,7 @@ LinearSystemSet::LinearSystemSet(vector<LinearSystem*> set){
 	for(int i=0; i<(signed)set.size(); i++){
 		if(!set[i]->isEmpty()){
 			this->set.push_back(set[i]);
+			MemoryTracker::addObjects(SYNTHESIS_SETS,1);
 		}
 	}
 }
@@ -57,6 +59,7 @@ vector<LinearSystem*> LinearSystemSet::getSet(){
 void LinearSystemSet::add(LinearSystem *LS){
 	if(!LS->isEmpty()){
 		this->set.push_back(LS);
+		MemoryTracker::addObjects(SYNTHESIS_SETS,1);
 	}
 }
 
@@ -68,18 +71,65 @@ void LinearSystemSet::add(LinearSystem *LS){
  */
 LinearSystemSet* LinearSystemSet::intersectWith(LinearSystemSet *LSset){
 
-	vector<LinearSystem*> intSet; // new intersection set
+	MemoryScope mem(SYNTHESIS_SETS);
+
 	vector<LinearSystem*> set = LSset->getSet();
+	int m = set.size();
+	int num_pairs = this->set.size()*m;
+
+	// build the candidate intersections
+	vector<LinearSystem*> candidates (num_pairs);
+	for(int k=0; k<num_pairs; k++){
+		candidates[k] = this->set[k/m]->appendLinearSystem(set[k%m]); // intersect
+	}
+
+	// check their emptiness in parallel
+	vector<char> empty (num_pairs);
+	ThreadPool::shared()->parallelFor(num_pairs,[&](int k){
+		empty[k] = candidates[k]->isEmpty();
+	});
+
+	// collect the non-empty intersections in the order of the pairs
+	LinearSystemSet *intSet = new LinearSystemSet(); // new intersection set
+	for(int k=0; k<num_pairs; k++){
+		if(!empty[k]){
+			intSet->set.push_back(candidates[k]);	// add inteserction
+			MemoryTracker::addObjects(SYNTHESIS_SETS,1);
+		}else{
+			delete candidates[k];
+		}
+	}
+	return intSet;
+}
+
+/**
+ * Signed violation of many points w.r.t. the union: the minimum over the
+ * members of their maximum violation (non-positive inside the union)
+ *
+ * @param[in] points points to test
+ * @returns violation of each point (HUGE_VAL if the set is empty)
+ */
+vector<double> LinearSystemSet::violations(const vector< vector<double> > &points){
 
+	vector<double> viol (points.size(),HUGE_VAL);
 	for(int i=0; i<(signed)this->set.size(); i++){
-		for(int j=0; j<(signed)set.size(); j++){
-			LinearSystem *intLS = this->set[i]->appendLinearSystem(set[j]); // intersect
-			if(!intLS->isEmpty()){
-				intSet.push_back(intLS);	// add inteserction
-			}
+		vector<double> viol_i = this->set[i]->violations(points);
+		for(int p=0; p<(signed)points.size(); p++){
+			viol[p] = min(viol[p],viol_i[p]);
 		}
 	}
-	return new LinearSystemSet(intSet);
+	return viol;
+}
+
+/**
+ * Membership of many points in the union
+ *
+ * @param[in] points points to test
+ * @param[in] tol tolerance on the violations
+ * @returns true for the points in some member of the set
+ */
+vector<bool> LinearSystemSet::contains(const vector< vector<double> > &points, double tol){
+	return LinearSystem::contains(this->violations(points),tol);
 }
 
 /**
@@ -90,6 +140,8 @@ LinearSystemSet* LinearSystemSet::intersectWith(LinearSystemSet *LSset){
  */
 LinearSystemSet* LinearSystemSet::unionWith(LinearSystemSet *LSset){
 
+	MemoryScope mem(SYNTHESIS_SETS);
+
 	vector<LinearSystem*> uniSet = this->set; 		// new union set
 	vector<LinearSystem*> set = LSset->getSet();
 
@@ -110,6 +162,8 @@ LinearSystemSet* LinearSystemSet::unionWith(LinearSystemSet *LSset){
  */
 LinearSystemSet* LinearSystemSet::boundedUnionWith(LinearSystemSet *LSset, int bound){
 
+	MemoryScope mem(SYNTHESIS_SETS);
+
 	if(this->size() > bound){
 		cout<<"LinearSystemSet::boundedUnionWith : size of actual box larger than bound";
 		exit (EXIT_FAILURE);
@@ -189,6 +243,6 @@ void LinearSystemSet::print() {
 }
 
 LinearSystemSet::~LinearSystemSet() {
-	// TODO Auto-generated destructor stub
+	MemoryTracker::addObjects(SYNTHESIS_SETS,-(long long)this->set.size());
 }
 
@@ -0,0 +1,249 @@
+/**
+ * @file Logger.cpp
+ * Per-thread ring buffers, the background writer, and the fork handlers
+ * that give each forked child its own writer
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <unistd.h>
+#include <pthread.h>
+#include <new>
+
+atomic<int> Logger::level (LOG_INFO);
+atomic<unsigned long long> Logger::seq (0);
+mutex Logger::lock;
+condition_variable Logger::wake;
+vector< shared_ptr<log_buffer> > Logger::buffers;
+thread* Logger::writer = NULL;
+atomic<int> Logger::writer_pid (0);
+bool Logger::stop = false;
+bool Logger::hooked = false;
+ofstream Logger::file;
+
+static const char *level_names[] = {"TRACE","DEBUG","INFO","WARN","ERROR"};
+
+/**
+ * Set the minimum level of the logged messages
+ *
+ * @param[in] level minimum level (LOG_OFF: nothing is logged)
+ */
+void Logger::setLevel(log_level level){
+	Logger::level = level;
+}
+
+/**
+ * Set the output of the logger
+ *
+ * @param[in] file_name output file (empty: stderr)
+ */
+void Logger::setOutput(string file_name){
+
+	Logger::flush();
+
+	lock_guard<mutex> guard(lock);
+	if( file.is_open() ){
+		file.close();
+	}
+	if( !file_name.empty() ){
+		file.open(file_name.c_str());
+		if( !file.is_open() ){
+			cout<<"Logger::setOutput : cannot open "<<file_name;
+			exit (EXIT_FAILURE);
+		}
+	}
+}
+
+/**
+ * Start the writer of this process (a forked child does not inherit it,
+ * childFork resets the state so that the child starts its own)
+ */
+void Logger::startWriter(){
+
+	lock_guard<mutex> guard(lock);
+	if( writer_pid == (int)getpid() ){
+		return;
+	}
+	if( !hooked ){		// inherited by the forked children
+		atexit(Logger::shutdown);
+		pthread_atfork(Logger::prepareFork,Logger::parentFork,Logger::childFork);
+		hooked = true;
+	}
+	writer_pid = getpid();
+	stop = false;
+	writer = new thread(&Logger::write);
+}
+
+/**
+ * Before a fork: hold the registry so that the child inherits it in a
+ * consistent state (and not locked by a thread that does not exist there)
+ */
+void Logger::prepareFork(){
+	lock.lock();
+}
+
+/**
+ * After a fork, in the parent: release the registry
+ */
+void Logger::parentFork(){
+	lock.unlock();
+}
+
+/**
+ * After a fork, in the child: only the forking thread survives. The writer
+ * and the buffers of the parent are abandoned (their pending messages are
+ * written by the parent, and their locks may be held by threads that do not
+ * exist in the child), the wake-up condition is re-created, and the registry
+ * is released by the thread that locked it
+ */
+void Logger::childFork(){
+
+	writer = NULL;		// not joinable from the child: deleting it would terminate
+	writer_pid = 0;
+	new (&wake) condition_variable();
+	new vector< shared_ptr<log_buffer> >(move(buffers));	// leaked on purpose: never touched again
+	buffers.clear();
+	lock.unlock();
+}
+
+/**
+ * Get the ring buffer of the calling thread
+ *
+ * @returns buffer of the calling thread
+ */
+log_buffer* Logger::localBuffer(){
+
+	static thread_local shared_ptr<log_buffer> buffer;
+
+	if( writer_pid != (int)getpid() ){
+		Logger::startWriter();
+	}
+	if( !buffer || buffer->pid != (int)getpid() ){		// first message, or first in a forked child
+		buffer = make_shared<log_buffer>();
+		buffer->ring.resize(capacity);
+		buffer->head = 0;
+		buffer->count = 0;
+		buffer->pid = getpid();
+
+		lock_guard<mutex> guard(lock);
+		buffers.push_back(buffer);
+	}
+	return buffer.get();
+}
+
+/**
+ * Log a message. The caller blocks only if its buffer is full
+ *
+ * @param[in] level level of the message
+ * @param[in] msg message
+ */
+void Logger::log(log_level level, const string &msg){
+
+	if( !Logger::enabled(level) ){
+		return;
+	}
+
+	log_buffer *buffer = Logger::localBuffer();
+	unique_lock<mutex> guard(buffer->lock);
+	if( buffer->count == capacity ){
+		wake.notify_one();
+		buffer->not_full.wait(guard,[buffer]{ return buffer->count < capacity; });
+	}
+
+	log_entry &entry = buffer->ring[(buffer->head + buffer->count) % capacity];
+	entry.seq = seq++;
+	entry.level = level;
+	entry.msg = msg;
+	buffer->count++;
+
+	if( buffer->count > capacity/2 ){
+		wake.notify_one();
+	}
+}
+
+/**
+ * Move the messages of all the buffers to the output
+ */
+void Logger::drain(){
+
+	lock_guard<mutex> guard(lock);
+
+	vector< log_entry > entries;
+	for(int i=0; i<(signed)buffers.size(); i++){
+		log_buffer *buffer = buffers[i].get();
+		{
+			lock_guard<mutex> buffer_guard(buffer->lock);
+			for(int k=0; k<buffer->count; k++){
+				log_entry &entry = buffer->ring[(buffer->head + k) % capacity];
+				entries.push_back(log_entry());
+				entries.back().seq = entry.seq;
+				entries.back().level = entry.level;
+				entries.back().msg.swap(entry.msg);
+			}
+			buffer->head = (buffer->head + buffer->count) % capacity;
+			buffer->count = 0;
+		}
+		buffer->not_full.notify_all();
+	}
+
+	sort(entries.begin(),entries.end(),[](const log_entry &e1, const log_entry &e2){ return e1.seq < e2.seq; });
+
+	ostream &out = file.is_open() ? (ostream&)file : cerr;
+	for(int i=0; i<(signed)entries.size(); i++){
+		out<<"["<<level_names[entries[i].level]<<"] "<<entries[i].msg<<"\n";
+	}
+}
+
+/**
+ * Loop of the background writer: drain the buffers every 50 ms or when a
+ * buffer is half full
+ */
+void Logger::write(){
+
+	unique_lock<mutex> guard(lock);
+	while( !stop ){
+		wake.wait_for(guard,chrono::milliseconds(50));
+		guard.unlock();
+		Logger::drain();
+		guard.lock();
+	}
+}
+
+/**
+ * Write all the pending messages
+ */
+void Logger::flush(){
+
+	Logger::drain();
+
+	lock_guard<mutex> guard(lock);
+	if( file.is_open() ){
+		file.flush();
+	}else{
+		cerr.flush();
+	}
+}
+
+/**
+ * Stop the writer and write the pending messages (at exit)
+ */
+void Logger::shutdown(){
+
+	{
+		lock_guard<mutex> guard(lock);
+		stop = true;
+	}
+	wake.notify_all();
+	if( writer != NULL && writer_pid == (int)getpid() ){
+		writer->join();
+		delete writer;
+		writer = NULL;
+	}
+	Logger::flush();
+}
@@ -0,0 +1,373 @@
+/**
+ * @file LowDimPolytope.cpp
+ * Clipping of the initial box (Sutherland-Hodgman on polygons and faces)
+ * and the volume, vertices, and support functions of the clipped polytope
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "LowDimPolytope.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdlib.h>
+
+const double LowDimPolytope::BOX = 1000000;
+
+static double dot(const vector<double> &a, const vector<double> &b){
+	double res = 0;
+	for(int i=0; i<(signed)a.size(); i++){
+		res += a[i]*b[i];
+	}
+	return res;
+}
+
+static double normInf(const vector<double> &a){
+	double res = 0;
+	for(int i=0; i<(signed)a.size(); i++){
+		res = max(res,fabs(a[i]));
+	}
+	return res;
+}
+
+/**
+ * Add a point to a list unless an (almost) identical point is already there
+ *
+ * @param[in,out] points list of points
+ * @param[in] p point to add
+ */
+static void pushUnique(vector< vector<double> > &points, const vector<double> &p){
+
+	double tol = 1e-9*(1 + normInf(p));
+	for(int i=0; i<(signed)points.size(); i++){
+		bool same = true;
+		for(int j=0; j<(signed)p.size() && same; j++){
+			same = fabs(points[i][j] - p[j]) <= tol;
+		}
+		if(same){
+			return;
+		}
+	}
+	points.push_back(p);
+}
+
+/**
+ * Constructor that clips the initial box with the constraints Ax<=b
+ *
+ * @param[in] A template matrix (1, 2, or 3 columns)
+ * @param[in] b offset vector
+ */
+LowDimPolytope::LowDimPolytope(vector< vector<double> > A, vector<double> b){
+
+	this->dim = A[0].size();
+	double B = LowDimPolytope::BOX;
+
+	switch( this->dim ){
+		case 1:{
+			this->vertices.push_back(vector<double> (1,-B));
+			this->vertices.push_back(vector<double> (1,B));
+		}
+		break;
+
+		case 2:{
+			double corners[4][2] = {{-B,-B},{B,-B},{B,B},{-B,B}};
+			vector< vector<double> > square;
+			for(int i=0; i<4; i++){
+				square.push_back(vector<double> (corners[i],corners[i]+2));
+			}
+			this->faces.push_back(square);
+		}
+		break;
+
+		case 3:{
+			for(int k=0; k<3; k++){		// two faces orthogonal to each axis
+				for(int s=-1; s<=1; s+=2){
+					double uv[4][2] = {{-B,-B},{B,-B},{B,B},{-B,B}};
+					vector< vector<double> > face;
+					for(int i=0; i<4; i++){
+						vector<double> p (3,0);
+						p[k] = s*B;
+						p[(k+1)%3] = uv[i][0];
+						p[(k+2)%3] = uv[i][1];
+						face.push_back(p);
+					}
+					this->faces.push_back(face);
+				}
+			}
+		}
+		break;
+
+		default:
+			cout<<"LowDimPolytope::LowDimPolytope : dimension must be 1, 2, or 3";
+			exit (EXIT_FAILURE);
+	}
+
+	for(int i=0; i<(signed)A.size(); i++){
+		this->clip(A[i],b[i]);
+	}
+
+	this->collectVertices();
+	this->computeVolume();
+
+	this->bounded = !this->vertices.empty();	// nothing is known if the clipped polytope vanishes (e.g., outside the box)
+	for(int i=0; i<(signed)this->vertices.size(); i++){
+		this->bounded = this->bounded && (normInf(this->vertices[i]) < B*(1 - 1e-9));
+	}
+}
+
+/**
+ * Intersect the polytope with the half-space ax<=b
+ *
+ * @param[in] a direction
+ * @param[in] b offset
+ */
+void LowDimPolytope::clip(vector<double> a, double b){
+
+	if( this->dim == 1 ){
+		if( this->vertices.empty() ){
+			return;
+		}
+		double lo = this->vertices[0][0];
+		double hi = this->vertices[1][0];
+		if( a[0] > 0 ){
+			hi = min(hi,b/a[0]);
+		}else if( a[0] < 0 ){
+			lo = max(lo,b/a[0]);
+		}else if( b < 0 ){
+			lo = hi + 1;		// 0 <= b unsatisfiable
+		}
+		this->vertices.clear();
+		if( lo <= hi ){
+			this->vertices.push_back(vector<double> (1,lo));
+			this->vertices.push_back(vector<double> (1,hi));
+		}
+		return;
+	}
+
+	vector< vector< vector<double> > > clipped;
+	vector< vector<double> > on_plane;
+
+	for(int i=0; i<(signed)this->faces.size(); i++){
+		vector< vector<double> > face = this->clipPolygon(this->faces[i],a,b,on_plane);
+		if( (signed)face.size() >= 3 ){
+			clipped.push_back(face);
+		}
+	}
+
+	if( this->dim == 3 ){		// close the polytope with the face lying on ax=b
+		vector< vector<double> > cap = this->capFace(on_plane,a);
+		if( (signed)cap.size() >= 3 ){
+			clipped.push_back(cap);
+		}
+	}
+
+	this->faces = clipped;
+}
+
+/**
+ * Sutherland-Hodgman clipping of a polygon with the half-space ax<=b
+ *
+ * @param[in] poly vertices of the polygon
+ * @param[in] a direction
+ * @param[in] b offset
+ * @param[out] on_plane points of the clipped polygon lying on ax=b
+ * @returns clipped polygon
+ */
+vector< vector<double> > LowDimPolytope::clipPolygon(vector< vector<double> > &poly, vector<double> &a, double b, vector< vector<double> > &on_plane){
+
+	vector< vector<double> > res;
+	int n = poly.size();
+	double tol = 1e-12*(1 + fabs(b));
+
+	for(int i=0; i<n; i++){
+
+		vector<double> &p = poly[i];
+		vector<double> &q = poly[(i+1)%n];
+		double dp = dot(a,p) - b;
+		double dq = dot(a,q) - b;
+
+		if( dp <= tol ){
+			res.push_back(p);
+			if( dp >= -tol ){
+				on_plane.push_back(p);
+			}
+		}
+
+		if( (dp < -tol && dq > tol) || (dp > tol && dq < -tol) ){
+			double t = dp/(dp - dq);
+			vector<double> x (p.size());
+			for(int j=0; j<(signed)p.size(); j++){
+				x[j] = p[j] + t*(q[j] - p[j]);
+			}
+			res.push_back(x);
+			on_plane.push_back(x);
+		}
+	}
+
+	return res;
+}
+
+/**
+ * Order the points lying on the plane ax=b to form a convex face
+ *
+ * @param[in] points points on the plane
+ * @param[in] a normal of the plane
+ * @returns vertices of the face in angular order
+ */
+vector< vector<double> > LowDimPolytope::capFace(vector< vector<double> > &points, vector<double> &a){
+
+	vector< vector<double> > face;
+	for(int i=0; i<(signed)points.size(); i++){
+		pushUnique(face,points[i]);
+	}
+	if( (signed)face.size() < 3 ){
+		return face;
+	}
+
+	// basis (u,v) of the plane
+	int k = 0;
+	for(int i=1; i<3; i++){
+		if( fabs(a[i]) < fabs(a[k]) ){
+			k = i;
+		}
+	}
+	double aa = dot(a,a);
+	vector<double> u (3,0);
+	u[k] = 1;
+	for(int i=0; i<3; i++){
+		u[i] -= a[k]/aa*a[i];
+	}
+	vector<double> v (3);
+	v[0] = a[1]*u[2] - a[2]*u[1];
+	v[1] = a[2]*u[0] - a[0]*u[2];
+	v[2] = a[0]*u[1] - a[1]*u[0];
+
+	vector<double> c (3,0);
+	for(int i=0; i<(signed)face.size(); i++){
+		for(int j=0; j<3; j++){
+			c[j] += face[i][j]/face.size();
+		}
+	}
+
+	vector< pair<double,int> > angles;
+	for(int i=0; i<(signed)face.size(); i++){
+		vector<double> d (3);
+		for(int j=0; j<3; j++){
+			d[j] = face[i][j] - c[j];
+		}
+		angles.push_back(pair<double,int> (atan2(dot(d,v),dot(d,u)),i));
+	}
+	sort(angles.begin(),angles.end());
+
+	vector< vector<double> > ordered;
+	for(int i=0; i<(signed)angles.size(); i++){
+		ordered.push_back(face[angles[i].second]);
+	}
+	return ordered;
+}
+
+/**
+ * Collect the vertices of the faces
+ */
+void LowDimPolytope::collectVertices(){
+
+	if( this->dim == 1 ){
+		return;
+	}
+
+	this->vertices.clear();
+	for(int i=0; i<(signed)this->faces.size(); i++){
+		for(int j=0; j<(signed)this->faces[i].size(); j++){
+			pushUnique(this->vertices,this->faces[i][j]);
+		}
+	}
+}
+
+/**
+ * Compute the volume and flag the polytopes whose volume is negligible
+ */
+void LowDimPolytope::computeVolume(){
+
+	this->vol = 0;
+
+	if( (signed)this->vertices.size() >= this->dim + 1 ){
+
+		switch( this->dim ){
+			case 1:
+				this->vol = this->vertices[1][0] - this->vertices[0][0];
+			break;
+
+			case 2:{	// shoelace formula
+				vector< vector<double> > &poly = this->faces[0];
+				for(int i=0; i<(signed)poly.size(); i++){
+					vector<double> &p = poly[i];
+					vector<double> &q = poly[(i+1)%poly.size()];
+					this->vol += p[0]*q[1] - q[0]*p[1];
+				}
+				this->vol = fabs(this->vol)/2;
+			}
+			break;
+
+			case 3:{	// tetrahedra from an interior point to the fans of the faces
+				vector<double> c (3,0);
+				for(int i=0; i<(signed)this->vertices.size(); i++){
+					for(int j=0; j<3; j++){
+						c[j] += this->vertices[i][j]/this->vertices.size();
+					}
+				}
+				for(int f=0; f<(signed)this->faces.size(); f++){
+					vector< vector<double> > &face = this->faces[f];
+					for(int i=1; i+1<(signed)face.size(); i++){
+						double e[3][3];
+						for(int j=0; j<3; j++){
+							e[0][j] = face[0][j] - c[j];
+							e[1][j] = face[i][j] - c[j];
+							e[2][j] = face[i+1][j] - c[j];
+						}
+						double det = e[0][0]*(e[1][1]*e[2][2] - e[1][2]*e[2][1])
+								   - e[0][1]*(e[1][0]*e[2][2] - e[1][2]*e[2][0])
+								   + e[0][2]*(e[1][0]*e[2][1] - e[1][1]*e[2][0]);
+						this->vol += fabs(det)/6;
+					}
+				}
+			}
+			break;
+		}
+	}
+
+	// negligible volume w.r.t. the bounding box: possibly flat or empty, to be decided by LP
+	double box_vol = 1;
+	for(int j=0; j<this->dim; j++){
+		double lo = LowDimPolytope::BOX, hi = -LowDimPolytope::BOX;
+		for(int i=0; i<(signed)this->vertices.size(); i++){
+			lo = min(lo,this->vertices[i][j]);
+			hi = max(hi,this->vertices[i][j]);
+		}
+		box_vol = box_vol*max(0.0,hi - lo);
+	}
+	this->empty = (box_vol <= 0) || (this->vol <= 1e-9*box_vol);
+}
+
+/**
+ * Support function of the polytope. The clipped vertices are computed in
+ * floating point and merged within 1e-9*(1+|v|), hence each one is moved
+ * outward by this tolerance to keep the bound sound
+ *
+ * @param[in] dir direction
+ * @returns maximum of dir*x over the vertices, inflated by the clipping tolerance
+ */
+double LowDimPolytope::support(vector<double> dir){
+
+	double dir_norm = 0;
+	for(int j=0; j<(signed)dir.size(); j++){
+		dir_norm += fabs(dir[j]);
+	}
+
+	double res = -LowDimPolytope::BOX*LowDimPolytope::BOX;
+	for(int i=0; i<(signed)this->vertices.size(); i++){
+		double tol = 1e-9*(1 + normInf(this->vertices[i]));
+		res = max(res,dot(dir,this->vertices[i]) + tol*dir_norm);
+	}
+	return res;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file MemoryTracker.cpp
+ * Counters of the tags and the operator new/delete hooks that prefix every
+ * block with its size and tag (built only with SAPO_MEMORY_HOOKS)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "MemoryTracker.h"
+
+#include <new>
+#include <sstream>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+atomic<bool> MemoryTracker::enabled (false);
+atomic<long long> MemoryTracker::live[NUM_TAGS];
+atomic<long long> MemoryTracker::peak[NUM_TAGS];
+atomic<long long> MemoryTracker::objects[NUM_TAGS];
+atomic<long long> MemoryTracker::total_live;
+atomic<long long> MemoryTracker::total_peak;
+atomic<long long> MemoryTracker::at_peak[NUM_TAGS];
+
+static thread_local mem_tag current_tag = UNTAGGED;
+
+static const char *tag_names[NUM_TAGS] = {"untagged","bernstein_cache","flowpipe","lp","synthesis_sets","reach_sets"};
+
+/**
+ * Get the tag charged by the calling thread
+ *
+ * @returns current tag
+ */
+mem_tag MemoryTracker::getTag(){
+	return current_tag;
+}
+
+/**
+ * Set the tag charged by the calling thread
+ *
+ * @param[in] tag new tag
+ */
+void MemoryTracker::setTag(mem_tag tag){
+	current_tag = tag;
+}
+
+/**
+ * Raise a peak counter to the given value
+ *
+ * @param[in,out] peak peak counter
+ * @param[in] value candidate peak
+ */
+void MemoryTracker::updatePeak(atomic<long long> &peak, long long value){
+	long long old_peak = peak.load(memory_order_relaxed);
+	while( value > old_peak && !peak.compare_exchange_weak(old_peak,value,memory_order_relaxed) ){
+	}
+}
+
+/**
+ * Charge an allocation to a tag
+ *
+ * @param[in] tag charged tag
+ * @param[in] bytes allocated bytes
+ */
+void MemoryTracker::allocated(mem_tag tag, long long bytes){
+
+	long long tag_live = live[tag].fetch_add(bytes,memory_order_relaxed) + bytes;
+	updatePeak(peak[tag],tag_live);
+
+	long long all_live = total_live.fetch_add(bytes,memory_order_relaxed) + bytes;
+	if( all_live > total_peak.load(memory_order_relaxed) ){
+		updatePeak(total_peak,all_live);
+		for(int i=0; i<NUM_TAGS; i++){		// remember who holds the memory at the peak
+			at_peak[i].store(live[i].load(memory_order_relaxed),memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * Release an allocation charged to a tag
+ *
+ * @param[in] tag charged tag
+ * @param[in] bytes released bytes
+ */
+void MemoryTracker::released(mem_tag tag, long long bytes){
+	live[tag].fetch_sub(bytes,memory_order_relaxed);
+	total_live.fetch_sub(bytes,memory_order_relaxed);
+}
+
+/**
+ * Check whether the allocator hooks are built, i.e., whether the bytes
+ * are charged to the tags
+ *
+ * @returns true if built with SAPO_MEMORY_HOOKS
+ */
+bool MemoryTracker::hooksBuilt(){
+#ifdef SAPO_MEMORY_HOOKS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * Peak resident set size of the process
+ *
+ * @returns peak RSS in KB
+ */
+long long MemoryTracker::peakRSS(){
+	struct rusage usage;
+	getrusage(RUSAGE_SELF,&usage);
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;		// bytes on macOS
+#else
+	return usage.ru_maxrss;
+#endif
+}
+
+/**
+ * Print the memory report: live, peak, and at-peak bytes of each tag
+ * and the explicit counters of the containers
+ *
+ * @param[in] out output stream
+ */
+void MemoryTracker::report(ostream &out){
+
+	out<<"Memory (peak RSS "<<peakRSS()<<" KB, tracked peak "<<total_peak/1024<<" KB)\n";
+	if( !hooksBuilt() ){
+		out<<"(allocator hooks not built, configure with -DSAPO_MEMORY_HOOKS=ON to charge the bytes)\n";
+	}
+	for(int i=0; i<NUM_TAGS; i++){
+		out<<tag_names[i]<<"\tlive: "<<live[i]/1024<<" KB\tpeak: "<<peak[i]/1024<<" KB";
+		out<<"\tat peak: "<<at_peak[i]/1024<<" KB\tobjects: "<<objects[i]<<"\n";
+	}
+}
+
+/**
+ * Memory report in JSON format
+ *
+ * @returns JSON object with the peak RSS and one field for each tag
+ */
+string MemoryTracker::toJSON(){
+
+	ostringstream json;
+	json<<"{\"peak_rss_kb\":"<<peakRSS()<<",\"hooks\":"<<(hooksBuilt() ? "true" : "false")<<",\"tracked_live\":"<<total_live<<",\"tracked_peak\":"<<total_peak;
+	for(int i=0; i<NUM_TAGS; i++){
+		json<<",\""<<tag_names[i]<<"\":{\"live\":"<<live[i]<<",\"peak\":"<<peak[i];
+		json<<",\"at_peak\":"<<at_peak[i]<<",\"objects\":"<<objects[i]<<"}";
+	}
+	json<<"}";
+	return json.str();
+}
+
+/**
+ * Constructor that starts charging a tag
+ *
+ * @param[in] tag tag to charge
+ */
+MemoryScope::MemoryScope(mem_tag tag){
+	this->previous = MemoryTracker::getTag();
+	MemoryTracker::setTag(tag);
+}
+
+MemoryScope::~MemoryScope() {
+	MemoryTracker::setTag(this->previous);
+}
+
+#ifdef SAPO_MEMORY_HOOKS
+
+/*
+ * Allocator hooks: each block is prefixed by a header with its size and tag,
+ * so that it is released from the tag that allocated it. The header costs
+ * 16 bytes per block (on 64-bit targets) even while the tracking is disabled,
+ * hence the hooks are built only with -DSAPO_MEMORY_HOOKS=ON
+ */
+
+static const size_t untracked = NUM_TAGS;	// tag of the blocks allocated while disabled
+
+struct alloc_header{
+	size_t size;
+	size_t tag;		// size_t keeps the block aligned as malloc
+};
+
+static void* trackedAlloc(size_t size){
+
+	alloc_header *h = (alloc_header*)malloc(sizeof(alloc_header) + size);
+	while( h == NULL ){
+		new_handler handler = get_new_handler();
+		if( handler == NULL ){
+			return NULL;
+		}
+		handler();
+		h = (alloc_header*)malloc(sizeof(alloc_header) + size);
+	}
+
+	h->size = size;
+	h->tag = untracked;
+	if( MemoryTracker::isEnabled() ){
+		h->tag = current_tag;
+		MemoryTracker::allocated(current_tag,size);
+	}
+	return h + 1;
+}
+
+static void trackedFree(void *p){
+	if( p != NULL ){
+		alloc_header *h = ((alloc_header*)p) - 1;
+		if( h->tag != untracked ){
+			MemoryTracker::released((mem_tag)h->tag,h->size);
+		}
+		free(h);
+	}
+}
+
+void* operator new(size_t size){
+	void *p = trackedAlloc(size);
+	if( p == NULL ){
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size){
+	void *p = trackedAlloc(size);
+	if( p == NULL ){
+		throw bad_alloc();
+	}
+	return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void *p) noexcept { trackedFree(p); }
+void operator delete[](void *p) noexcept { trackedFree(p); }
+void operator delete(void *p, const nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void *p, const nothrow_t&) noexcept { trackedFree(p); }
+
+#endif /* SAPO_MEMORY_HOOKS */
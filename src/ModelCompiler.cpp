@@ -0,0 +1,89 @@
+/**
+ * @file ModelCompiler.cpp
+ * Symbolic stage of the compilation: control points of each
+ * parallelotope/direction pair of the initial set
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "ModelCompiler.h"
+
+/**
+ * Constructor that instantiates the compiler
+ *
+ * @param[in] model model to compile
+ * @param[in] options options of the analysis (transformation mode)
+ */
+ModelCompiler::ModelCompiler(Model *model, sapo_opt options){
+	this->model = model;
+	this->options = options;
+}
+
+/**
+ * Compile the model. The artifact supports the reachability with the
+ * template of the initial set (no decompositions, disturbances or lookahead)
+ *
+ * @returns compiled model
+ */
+CompiledModel* ModelCompiler::compile(){
+
+	if( this->options.decomp > 0 || this->options.lookahead > 1 || this->model->getDists().nops() > 0 || this->model->isPiecewise() ){
+		cout<<"ModelCompiler::compile : decompositions, lookahead, disturbances and piecewise dynamics are not supported by the runtime";
+		exit (EXIT_FAILURE);
+	}
+
+	Bundle *B = this->model->getReachSet();
+	lst vars = this->model->getVars();
+	lst params = this->model->getParams();
+	lst dyns = this->model->getDyns();
+	int dim = B->getDim();
+
+	vector< double > offp, offm;
+	for(int i=0; i<B->getSize(); i++){
+		offp.push_back(B->getOffp(i));
+		offm.push_back(B->getOffm(i));
+	}
+
+	// parameter set (a single polytope)
+	vector< vector< double > > paraA;
+	vector< double > parab;
+	if( params.nops() > 0 ){
+		if( this->model->getParaSet() == NULL || this->model->getParaSet()->size() != 1 ){
+			cout<<"ModelCompiler::compile : parametric models need exactly one parameter set";
+			exit (EXIT_FAILURE);
+		}
+		paraA = this->model->getParaSet()->getSet()[0]->getA();
+		parab = this->model->getParaSet()->getSet()[0]->getb();
+	}
+
+	CompiledModel *res = new CompiledModel(this->model->getName(),dim,params.nops(),this->options.trans,B->getDirections(),offp,offm,paraA,parab);
+
+	// the generator functions do not depend on the offsets as long as the widths are positive
+	vector< vector< int > > T;
+	for(int i=0; i<B->getCard(); i++){
+		T.push_back(B->getTemplate(i));
+	}
+	Bundle *unit = new Bundle(B->getDirections(),vector< double > (B->getSize(),1),vector< double > (B->getSize(),0),T);
+
+	// same symbolic stage as the analysis (shared compositions, closed-form affine directions)
+	ControlPointCache *cache = new ControlPointCache(0);
+	vector< vector< double > > values;
+	vector< bound_job > jobs = unit->prepareTransform(vars,params,dyns,cache,this->options.trans,NULL,values);
+
+	for(int i=0; i<unit->getCard(); i++){	// for each parallelotope
+		vector< int > bound_dirs;
+		vector< compact_points > controlPts;
+		for(int t=0; t<(signed)jobs.size(); t++){
+			if( jobs[t].par == i ){
+				bound_dirs.push_back(jobs[t].dir);
+				controlPts.push_back(*jobs[t].controlPts);
+			}
+		}
+		res->addTemplate(T[i],bound_dirs,controlPts);
+	}
+	delete cache;
+	delete unit;
+
+	return res;
+}
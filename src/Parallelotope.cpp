@@ -239,7 +239,10 @@ Parallelotope::Parallelotope(vector<lst> vars, LinearSystem *constr) {
 }
 
 /**
- * Constructor generator to constraints representation
+ * Constructor generator to constraints representation. The facet normals
+ * are the rows n_i of the inverse of the versor matrix U (n_i u_j = 1 if
+ * i = j, 0 otherwise), so that n_i x ranges in [n_i q, n_i q + beta_i] over
+ * the parallelotope: one numerical inversion gives all the 2*dim facets
  *
  * @param[in] q numerical base vertex
  * @param[in] beta numerical generator lengths
@@ -252,82 +255,31 @@ LinearSystem* Parallelotope::gen2const(vector<double> q, vector<double> beta){
 		exit (EXIT_FAILURE);
 	}
 
-
-	vector< vector<double> > hps;	// hyperplane equations
-
-	// first set of hyperplanes
+	// versor matrix (one column for each versor)
+	vector< vector<double> > U (this->dim,vector<double> (this->dim,0));
 	for(int i=0; i<this->dim; i++){
-
-		vector< vector<double> > pts;
-		pts.push_back(q);							// add base vertex
-
-		for(int j=0; j<this->dim; j++){ 			// for all the generators u
-			if( i != j ){
-				vector<double> p;
-				for(int k =0; k<this->dim; k++){	// coordinate of the point
-					p.push_back(q[k] + this->u[j][k]*beta[j]);
-				}
-				pts.push_back(p);
-			}
+		for(int j=0; j<this->dim; j++){
+			U[j][i] = this->u[i][j];
 		}
-		hps.push_back(hyperplaneThroughPts(pts));
 	}
-
-	//second set of hyperplanes
-	for(int i=0; i<this->dim; i++){
-
-			vector< vector<double> > pts;
-
-			vector<double> qt; // traslate q
-			for(int j=0; j<this->dim; j++){
-				qt.push_back(q[j] + beta[i]*this->u[i][j]);
-			}
-			pts.push_back(qt);							// add base vertex
-
-			for(int j=0; j<this->dim; j++){ 			// for all the generators u
-				if( i != j ){
-					vector<double> p;
-					for(int k =0; k<this->dim; k++){	// coordinate of the point
-						p.push_back( (q[k] + this->u[j][k]*beta[j]) + beta[i]*this->u[i][k]);
-					}
-					pts.push_back(p);
-				}
-			}
-
-			hps.push_back(hyperplaneThroughPts(pts));
-
+	vector< vector<double> > Uinv;
+	if( !DenseMatrix::invert(U,Uinv) ){
+		cout<<"Parallelotope::gen2const : the versors must be linearly independent";
+		exit (EXIT_FAILURE);
 	}
 
-	vector< vector<double> > Lambda;
+	vector< vector<double> > Lambda (this->dim*2,vector<double> (this->dim,0));
 	vector< double > d (this->dim*2,0);
-
-	// initialize template Lambda
-	vector<double> Lambda_i (this->dim,0);
-	for(int i=0; i<(this->dim)*2; i++){
-		Lambda.push_back(Lambda_i);
-	}
+	vector< double > nq = DenseMatrix::mult(Uinv,q);
 
 	for(int i=0; i<this->dim; i++){
-
-		// find hyperplane with smaller direction
-		double b1 = -hps[i][hps[i].size()-1];
-		double b2 = -hps[i+this->dim][hps[i].size()-1];
-
-		if(b1 > b2){
-			d[i] = b1;
-			d[i+this->dim] = -b2;
-			for(int j=0; j<this->dim; j++){
-				Lambda[i][j] = hps[i][j];
-				Lambda[i+this->dim][j] = -hps[i+this->dim][j];
-			}
-		}else{
-			d[i] = -b1;
-			d[i+this->dim] = b2;
-			for(int j=0; j<this->dim; j++){
-				Lambda[i][j] = -hps[i][j];
-				Lambda[i+this->dim][j] = hps[i+this->dim][j];
-			}
+		// upper facet along n_i and lower facet along -n_i
+		for(int j=0; j<this->dim; j++){
+			Lambda[i][j] = Uinv[i][j];
+			Lambda[i+this->dim][j] = -Uinv[i][j];
 		}
+		d[i] = max(nq[i],nq[i] + beta[i]);
+		d[i+this->dim] = -min(nq[i],nq[i] + beta[i]);
 	}
 
 	LinearSystem *LS = new LinearSystem(Lambda,d);
@@ -378,80 +330,6 @@ int Parallelotope::getDim(){ return this->dim; }
 vector< vector< double > > Parallelotope::getTemplate(){ return this->template_matrix; }
 
 
-/**
- * Determine the equation of the hyperplane passing through some points, i.e.,
- * res[0]*x_0 + .. + res[n]*x_n + res[n+1] = 0
- *
- * @param[in] pts interpolation points
- * @returns interpolating function coefficients
- */
-vector<double> Parallelotope::hyperplaneThroughPts(vector< vector<double> > pts){
-
-	if(pts.size() != pts[0].size()){
-		cout<<"Parallelotope::hyperplaneThroughPts : pts must contain n n-dimensional points";
-		exit (EXIT_FAILURE);
-	}
-
-	vector< vector<double> > A;
-	// build the linear system Ax = 0
-	for(int i=1; i<(signed)pts.size(); i++){
-		vector<double> Ai;
-		for(int j=0; j < this->dim; j++){
-			Ai.push_back(pts[0][j] - pts[i][j]);
-		}
-		A.push_back(Ai);
-	}
-
-	// Build the linear system to find the normal vector
-	lst LS;
-	lst a = this->vars[1];
-
-	for(int i=0; i<this->dim-1; i++){
-
-		ex eq = 0;
-		lst sub;
-
-		for(int j=0; j<this->dim; j++){
-			eq = eq + A[i][j]*a[j];
-		}
-
-		eq = eq == 0;
-		LS.append(eq);
-
-	}
-
-	// Solve the linear system
-	ex solLS = lsolve(LS,a);
-
-	// Build the linear inequality
-	lst x = this->vars[0];
-	ex eqr = 0;
-	vector<double> lambda (this->dim+1,0);
-
-	ex sub;
-	int sub_idx;
-	// search for the tautology
-	for(int i=0; i<(signed)solLS.nops(); i++){
-		if(solLS[i].is_equal(a[i] == a[i])){
-			sub = a[i] == 1;
-			sub_idx = i;
-		}
-	}
-
-	lambda[sub_idx] = 1;
-	for(int i=0; i<this->dim; i++){
-		if(i != sub_idx){
-			lambda[i] = ex_to<numeric>(evalf(a[i].subs(solLS[i].subs(sub)))).to_double();
-		}
-		eqr = eqr + a[i].subs(a[i] == lambda[i])*pts[0][i];
-	}
-
-	lambda[this->dim] = -ex_to<numeric>(evalf(eqr)).to_double();
-
-	return lambda;
-}
-
-
 /**
  * Convert the constraint representation to the generator one
  *
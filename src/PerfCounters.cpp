@@ -0,0 +1,274 @@
+/**
+ * @file PerfCounters.cpp
+ * Per-thread perf_event_open groups, their per-phase readings, and the
+ * run report
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "PerfCounters.h"
+
+#include <sstream>
+#include <chrono>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+atomic<bool> PerfCounters::enabled (false);
+mutex PerfCounters::lock;
+vector<perf_thread*> PerfCounters::threads;
+
+static const char *phase_names[NUM_PHASES] = {"transform","bernstein","lp"};
+
+/**
+ * Current wall-clock time
+ *
+ * @returns seconds from an arbitrary epoch
+ */
+static double wallTime(){
+	return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Get the counters of the calling thread, registering them at the first call
+ *
+ * @returns counters of the calling thread
+ */
+perf_thread* PerfCounters::current(){
+
+	static thread_local perf_thread *t = NULL;
+
+	if( t == NULL ){
+		perf_reading zero = {0,0,0,0,0,0};
+		t = new perf_thread;
+		t->fd = openCounters();
+		t->phases = vector<perf_reading> (NUM_PHASES,zero);
+
+		lock_guard<mutex> guard(lock);
+		t->id = threads.size();
+		threads.push_back(t);
+	}
+	return t;
+}
+
+/**
+ * Open a group of counters for the calling thread
+ *
+ * @returns file descriptor of the group leader (-1 if the counters are not available)
+ */
+int PerfCounters::openCounters(){
+
+#ifdef __linux__
+	unsigned long long configs[4] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+									 PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+	int fds[4];
+	int leader = -1;
+
+	for(int i=0; i<4; i++){
+		struct perf_event_attr attr;
+		memset(&attr,0,sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = configs[i];
+		attr.exclude_kernel = 1;		// allowed with perf_event_paranoid <= 2
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+		if( fds[i] < 0 ){				// counters not available: fall back to timers
+			for(int j=0; j<i; j++){
+				close(fds[j]);
+			}
+			return -1;
+		}
+		if( i == 0 ){
+			leader = fds[0];
+		}
+	}
+	return leader;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * Check whether the hardware counters can be sampled by the calling thread
+ *
+ * @returns true if the counters are available
+ */
+bool PerfCounters::hardwareAvailable(){
+	return current()->fd >= 0;
+}
+
+/**
+ * Read the counters of a thread
+ *
+ * @param[in] t thread counters
+ * @param[out] values cycles, instructions, LLC misses, and branch misses
+ */
+void PerfCounters::read(perf_thread *t, long long values[4]){
+
+	for(int i=0; i<4; i++){
+		values[i] = 0;
+	}
+
+#ifdef __linux__
+	if( t->fd >= 0 ){
+		unsigned long long buf[5];		// number of counters followed by their values
+		if( ::read(t->fd,buf,sizeof(buf)) == sizeof(buf) ){
+			for(int i=0; i<4; i++){
+				values[i] = buf[i+1];
+			}
+		}
+	}
+#endif
+}
+
+/**
+ * Accumulate a sample in a phase of a thread
+ *
+ * @param[in] t thread counters
+ * @param[in] phase sampled phase
+ * @param[in] time elapsed wall-clock time
+ * @param[in] start counters at the beginning of the sample
+ * @param[in] end counters at the end of the sample
+ */
+void PerfCounters::add(perf_thread *t, perf_phase phase, double time, long long start[4], long long end[4]){
+	perf_reading &r = t->phases[phase];
+	r.calls++;
+	r.time += time;
+	r.cycles += end[0] - start[0];
+	r.instructions += end[1] - start[1];
+	r.llc_misses += end[2] - start[2];
+	r.branch_misses += end[3] - start[3];
+}
+
+/**
+ * Sum the readings of all the threads
+ *
+ * @returns one reading for each phase
+ */
+vector<perf_reading> PerfCounters::aggregate(){
+
+	perf_reading zero = {0,0,0,0,0,0};
+	vector<perf_reading> total (NUM_PHASES,zero);
+
+	lock_guard<mutex> guard(lock);
+	for(int i=0; i<(signed)threads.size(); i++){
+		for(int p=0; p<NUM_PHASES; p++){
+			perf_reading r = threads[i]->phases[p];
+			total[p].calls += r.calls;
+			total[p].time += r.time;
+			total[p].cycles += r.cycles;
+			total[p].instructions += r.instructions;
+			total[p].llc_misses += r.llc_misses;
+			total[p].branch_misses += r.branch_misses;
+		}
+	}
+	return total;
+}
+
+/**
+ * Clear the readings of all the threads
+ */
+void PerfCounters::reset(){
+	perf_reading zero = {0,0,0,0,0,0};
+	lock_guard<mutex> guard(lock);
+	for(int i=0; i<(signed)threads.size(); i++){
+		threads[i]->phases = vector<perf_reading> (NUM_PHASES,zero);
+	}
+}
+
+/**
+ * Print a reading
+ *
+ * @param[in] out output stream
+ * @param[in] r reading to print
+ */
+void PerfCounters::printReading(ostream &out, perf_reading r){
+	out<<"calls: "<<r.calls<<"\ttime: "<<r.time;
+	out<<"\tcycles: "<<r.cycles<<"\tinstructions: "<<r.instructions;
+	if( r.cycles > 0 ){
+		out<<"\tIPC: "<<(double)r.instructions/r.cycles;
+	}
+	out<<"\tLLC misses: "<<r.llc_misses<<"\tbranch misses: "<<r.branch_misses<<"\n";
+}
+
+/**
+ * Print the run report: totals of each phase followed by the readings of each thread.
+ * Phases are inclusive (e.g., transform includes the Bernstein and LP phases it calls)
+ *
+ * @param[in] out output stream
+ */
+void PerfCounters::report(ostream &out){
+
+	vector<perf_reading> total = aggregate();
+
+	out<<"Performance counters"<<(hardwareAvailable() ? "" : " (hardware counters not available)")<<"\n";
+	for(int p=0; p<NUM_PHASES; p++){
+		out<<phase_names[p]<<"\t";
+		printReading(out,total[p]);
+	}
+
+	lock_guard<mutex> guard(lock);
+	if( threads.size() > 1 ){
+		for(int i=0; i<(signed)threads.size(); i++){
+			for(int p=0; p<NUM_PHASES; p++){
+				if( threads[i]->phases[p].calls > 0 ){
+					out<<"thread "<<threads[i]->id<<" "<<phase_names[p]<<"\t";
+					printReading(out,threads[i]->phases[p]);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Totals of each phase in JSON format
+ *
+ * @returns JSON object with one field for each phase
+ */
+string PerfCounters::toJSON(){
+
+	vector<perf_reading> total = aggregate();
+
+	ostringstream json;
+	json<<"{\"hardware\":"<<(hardwareAvailable() ? "true" : "false");
+	for(int p=0; p<NUM_PHASES; p++){
+		json<<",\""<<phase_names[p]<<"\":{\"calls\":"<<total[p].calls<<",\"time\":"<<total[p].time;
+		json<<",\"cycles\":"<<total[p].cycles<<",\"instructions\":"<<total[p].instructions;
+		json<<",\"llc_misses\":"<<total[p].llc_misses<<",\"branch_misses\":"<<total[p].branch_misses<<"}";
+	}
+	json<<"}";
+	return json.str();
+}
+
+/**
+ * Constructor that starts sampling a phase (nothing is done if sampling is off)
+ *
+ * @param[in] phase phase to sample
+ */
+PerfScope::PerfScope(perf_phase phase){
+	this->phase = phase;
+	this->thread = NULL;
+	if( PerfCounters::isEnabled() ){
+		this->thread = PerfCounters::current();
+		PerfCounters::read(this->thread,this->start);
+		this->tStart = wallTime();
+	}
+}
+
+PerfScope::~PerfScope() {
+	if( this->thread != NULL ){
+		long long end[4];
+		double time = wallTime() - this->tStart;
+		PerfCounters::read(this->thread,end);
+		PerfCounters::add(this->thread,this->phase,time,this->start,end);
+	}
+}
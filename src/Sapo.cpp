@@ -9,6 +9,9 @@
 
 #include "Sapo.h"
 
+#include <sstream>
+#include <set>
+
 /**
  * Constructor that instantiates Sapo
  *
@@ -20,6 +23,98 @@ Sapo::Sapo(Model *model, sapo_opt options) {
 	this->params = model->getParams();
 	this->dyns = model->getDyns();
 	this->options = options;
+	this->synth_dyns = this->dyns;
+	this->dists = NULL;
+	if( model->getDists().nops() > 0 ){
+		this->initDisturbances(model);
+	}
+	this->guardControlPts = NULL;
+	if( model->isPiecewise() ){
+		this->initPiecewise(model);
+	}
+
+	this->reachControlPts = new ControlPointCache((long long)(options.cache_mb*1024*1024));
+	this->synthControlPts = new ControlPointCache((long long)(options.cache_mb*1024*1024));
+	this->monotone_steps = 0;
+	this->refine_calls = 0;
+	this->refine_in = 0;
+	this->refine_out = 0;
+	this->piecewise_steps = 0;
+	this->active_modes = 0;
+
+	PerfCounters::enable(options.perf_counters);
+	if( options.mem_report || !options.mem_metrics.empty() ){
+		MemoryTracker::enable();
+	}
+	if( !options.mem_metrics.empty() ){
+		this->metrics.open(options.mem_metrics.c_str());
+	}
+	ThreadPool::setThreads(options.threads);
+	Logger::setLevel(options.trace ? LOG_TRACE : (options.verbose ? LOG_DEBUG : LOG_INFO));
+	if( !options.log_file.empty() ){
+		Logger::setOutput(options.log_file);
+	}
+}
+
+/**
+ * Initialize the per-step disturbances. A disturbance d \in [lb,ub] entering all
+ * the dynamics linearly with constant coefficients is removed from the dynamics
+ * and bounded in closed form, while the others are replaced by lb + (ub-lb)*delta
+ * with delta \in [0,1] added to the variables of the Bernstein expansion
+ *
+ * @param[in] model model with the disturbances
+ */
+void Sapo::initDisturbances(Model *model){
+
+	lst dvars = model->getDists();
+	vector< double > lb = model->getDistLB();
+	vector< double > ub = model->getDistUB();
+	int num_dists = dvars.nops();
+
+	if( (signed)lb.size() != num_dists || (signed)ub.size() != num_dists ){
+		cout<<"Sapo::initDisturbances : the disturbances must have "<<num_dists<<" lower and upper bounds";
+		exit (EXIT_FAILURE);
+	}
+
+	this->dists = new disturbance_box;
+	this->dists->lb = lb;
+	this->dists->ub = ub;
+	this->dists->D = vector< vector< double > > (this->vars.nops(),vector< double > (num_dists,0));
+
+	lst sub_all, sub_nonlinear;
+	for(int i=0; i<num_dists; i++){
+
+		ostringstream name;
+		name<<"dd"<<i+1;
+		symbol delta(name.str());
+		this->dists->deltas.append(delta);
+		sub_all.append(dvars[i] == lb[i] + (ub[i] - lb[i])*delta);
+
+		// check whether d_i enters additively with constant coefficients
+		bool additive = true;
+		for(int k=0; k<(signed)this->dyns.nops(); k++){
+			ex fk = this->dyns[k].expand();
+			if( fk.degree(dvars[i]) > 1 || !is_a<numeric>(evalf(fk.coeff(dvars[i],1))) ){
+				additive = false;
+			}
+		}
+		this->dists->additive.push_back(additive);
+
+		if( additive ){
+			for(int k=0; k<(signed)this->dyns.nops(); k++){
+				ex fk = this->dyns[k].expand();
+				this->dists->D[k][i] = ex_to<numeric>(evalf(fk.coeff(dvars[i],1))).to_double();
+				this->dyns[k] = fk.coeff(dvars[i],0);		// remove the additive term
+			}
+		}else{
+			sub_nonlinear.append(dvars[i] == lb[i] + (ub[i] - lb[i])*delta);
+		}
+	}
+
+	for(int k=0; k<(signed)this->dyns.nops(); k++){
+		this->dyns[k] = this->dyns[k].subs(sub_nonlinear);
+		this->synth_dyns[k] = this->synth_dyns[k].subs(sub_all);
+	}
 }
 
 /**
@@ -33,35 +128,103 @@ Flowpipe* Sapo::reach(Bundle* initSet, int k){
 
 	Flowpipe *flowpipe = new Flowpipe();
 
+	if(this->options.zonotope_gens > 0 && initSet->getZonotopes().empty()){	// add the zonotope member
+		initSet = new Bundle(*initSet);
+		initSet->addZonotope(new Zonotope(initSet->getParallelotope(0),this->options.zonotope_gens));
+	}
+
+	if(this->options.perf_counters){	// report this analysis only
+		PerfCounters::reset();
+	}
+
 	clock_t tStart = clock();
-	if(this->options.verbose){
-		initSet->getBundle()->print();
+	if(Logger::enabled(LOG_DEBUG)){
+		Logger::log(LOG_DEBUG,"step 0 "+initSet->toCompact(true));
 	}
 	flowpipe->append(initSet);
 
-	cout<<"Computing reach set..."<<flush;
+	cout<<"Computing reach set...";
+
+	int lookahead = max(1,this->options.lookahead);
 
-	for(int i=0; i<k; i++){
+	for(int i=0; i<k; i+=lookahead){
 
 		//cout<<"Reach step "<<i<<"\n";
 
-		Bundle *X = flowpipe->get(i);	// get actual set
-		X = X->transform(this->vars,this->dyns,this->reachControlPts,this->options.trans);	// transform it
+		int h = min(lookahead,k-i);		// steps bounded at once
+		Bundle *X = flowpipe->get(flowpipe->size()-1);	// get actual set
+		vector< Bundle* > Xs;
+		{
+			MemoryScope mem(REACH_SETS);	// charge the computed bundles
+			if( lookahead > 1 ){
+				Xs = this->lookaheadTransform(X,NULL,h);	// transform it with f^h
+			}else{
+				Bundle *Y = this->options.monotone ? this->monotoneTransform(X) : NULL;	// exact on certified boxes
+				if( Y == NULL && !this->modeDyns.empty() ){
+					Y = this->piecewiseTransform(X,NULL);	// transform it with the active modes
+				}
+				if( Y == NULL ){
+					Y = X->transform(this->vars,this->dyns,this->reachControlPts,this->options.trans,this->dists);	// transform it
+				}
+				Xs.push_back(Y);
+			}
 
-		if(this->options.decomp > 0){	// eventually decompose it
-			X = X->decompose(this->options.alpha,this->options.decomp);
+			if(this->options.decomp > 0){	// eventually decompose it
+				Xs.back() = Xs.back()->decompose(this->options.alpha,this->options.decomp);
+			}
 		}
-		if(this->options.verbose){
-			X->getBundle()->print();
+		for(int j=0; j<(signed)Xs.size(); j++){
+			if(Logger::enabled(LOG_DEBUG)){
+				ostringstream msg;
+				msg<<"step "<<i+h-(signed)Xs.size()+j+1<<" "<<Xs[j]->toCompact(this->options.decomp > 0);
+				Logger::log(LOG_DEBUG,msg.str());
+			}
+			flowpipe->append(Xs[j]);			// store result
 		}
 
-		flowpipe->append(X);			// store result
+		this->writeMetrics(i+h);
 	}
 	cout<<"Done.\tTime taken:"<<double(clock() - tStart) / CLOCKS_PER_SEC<<"\n";
+	if(this->piecewise_steps > 0){
+		ostringstream msg;
+		msg<<"piecewise dynamics: "<<(double)this->active_modes/this->piecewise_steps<<" of "<<this->modeDyns.size()<<" modes bounded per step";
+		Logger::log(LOG_INFO,msg.str());
+	}
+	if(this->options.monotone){
+		ostringstream msg;
+		msg<<"corner propagation: "<<this->monotone_steps<<" of "<<k<<" steps";
+		Logger::log(LOG_INFO,msg.str());
+	}
+	Logger::flush();
+
+	if(this->options.perf_counters){
+		PerfCounters::report(cout);
+	}
+	if(this->options.mem_report){
+		MemoryTracker::report(cout);
+		this->reachControlPts->report(cout,"reach");
+		this->synthControlPts->report(cout,"synthesis");
+		if(this->guardControlPts != NULL){
+			this->guardControlPts->report(cout,"guards");
+		}
+	}
 
 	return flowpipe;
 }
 
+/**
+ * Append the memory of a reach step to the metrics file, if any
+ *
+ * @param[in] step reach step
+ */
+void Sapo::writeMetrics(int step){
+	if(this->metrics.is_open()){
+		this->metrics<<"{\"step\":"<<step<<",\"memory\":"<<MemoryTracker::toJSON();
+		this->metrics<<",\"reach_cache\":"<<this->reachControlPts->toJSON()<<",\"synth_cache\":"<<this->synthControlPts->toJSON()<<"}\n";
+		this->metrics.flush();
+	}
+}
+
 /**
  * Reachable set computation for parameteric dynamical systems
  *
@@ -72,41 +235,537 @@ Flowpipe* Sapo::reach(Bundle* initSet, int k){
  */
 Flowpipe* Sapo::reach(Bundle* initSet, LinearSystem* paraSet, int k){
 
+	if( this->options.zonotope_gens > 0 || !initSet->getZonotopes().empty() ){
+		cout<<"Sapo::reach : the parametric reachability does not support zonotope members";
+		exit (EXIT_FAILURE);
+	}
+
 	Flowpipe *flowpipe = new Flowpipe();
 
-	cout<<"Computing parametric reach set..."<<flush;
+	cout<<"Computing parametric reach set...";
+
+	if(this->options.perf_counters){	// report this analysis only
+		PerfCounters::reset();
+	}
 
 	clock_t tStart = clock();
-	if(this->options.verbose){
-		initSet->getBundle()->print();
+	if(Logger::enabled(LOG_DEBUG)){
+		Logger::log(LOG_DEBUG,"step 0 "+initSet->toCompact(true));
 	}
 	flowpipe->append(initSet);
 
 
-	for(int i=0; i<k; i++){
+	int lookahead = max(1,this->options.lookahead);
+
+	for(int i=0; i<k; i+=lookahead){
 
 		//cout<<"Reach step "<<i<<"\n";
 
-		Bundle *X = flowpipe->get(i);	// get actual set
-		X = X->transform(this->vars,this->params, this->dyns, paraSet, this->synthControlPts, this->options.trans);	// transform it
+		int h = min(lookahead,k-i);		// steps bounded at once
+		Bundle *X = flowpipe->get(flowpipe->size()-1);	// get actual set
+		vector< Bundle* > Xs;
+		{
+			MemoryScope mem(REACH_SETS);	// charge the computed bundles
+			if( lookahead > 1 ){
+				Xs = this->lookaheadTransform(X,paraSet,h);	// transform it with f^h
+			}else if( !this->modeDyns.empty() ){
+				Xs.push_back(this->piecewiseTransform(X,paraSet));	// transform it with the active modes
+			}else{
+				Xs.push_back(X->transform(this->vars,this->params, this->dyns, paraSet, this->synthControlPts, this->options.trans, this->dists));	// transform it
+			}
 
-		if(this->options.decomp > 0){	// eventually decompose it
-			X = X->decompose(this->options.alpha,this->options.decomp);
+			if(this->options.decomp > 0){	// eventually decompose it
+				Xs.back() = Xs.back()->decompose(this->options.alpha,this->options.decomp);
+			}
 		}
 
-		if(this->options.verbose){
-			X->getBundle()->print();
+		for(int j=0; j<(signed)Xs.size(); j++){
+			if(Logger::enabled(LOG_DEBUG)){
+				ostringstream msg;
+				msg<<"step "<<i+h-(signed)Xs.size()+j+1<<" "<<Xs[j]->toCompact(this->options.decomp > 0);
+				Logger::log(LOG_DEBUG,msg.str());
+			}
+			flowpipe->append(Xs[j]);			// store result
 		}
 
-		flowpipe->append(X);			// store result
+		this->writeMetrics(i+h);
 	}
 
 	cout<<"Done.\tTime taken:"<<double(clock() - tStart) / CLOCKS_PER_SEC<<"\n";
+	if(this->piecewise_steps > 0){
+		ostringstream msg;
+		msg<<"piecewise dynamics: "<<(double)this->active_modes/this->piecewise_steps<<" of "<<this->modeDyns.size()<<" modes bounded per step";
+		Logger::log(LOG_INFO,msg.str());
+	}
+	Logger::flush();
+
+	if(this->options.perf_counters){
+		PerfCounters::report(cout);
+	}
+	if(this->options.mem_report){
+		MemoryTracker::report(cout);
+		this->reachControlPts->report(cout,"reach");
+		this->synthControlPts->report(cout,"synthesis");
+		if(this->guardControlPts != NULL){
+			this->guardControlPts->report(cout,"guards");
+		}
+	}
 
 	return flowpipe;
 
 }
 
+/**
+ * Compose the dynamics with themselves up to options.lookahead times. When
+ * options.lookahead_degree > 0, the terms of f^j of higher total degree are
+ * moved to a remainder that is bounded by interval arithmetic at each use.
+ * The terms of degree higher than one in the parameters (e.g., beta^2 in the
+ * composition of beta*s*i) always go to the remainder, since the parametric
+ * transformation needs control points affine in the parameters
+ */
+void Sapo::initLookahead(){
+
+	if( !this->lookaheadDyns.empty() ){
+		return;
+	}
+	if( this->dists != NULL ){
+		cout<<"Sapo::initLookahead : the lookahead does not support disturbances";
+		exit (EXIT_FAILURE);
+	}
+
+	int dim = this->vars.nops();
+	symbol t("t"), u("u");
+	lst scale, para_scale;
+	for(int i=0; i<dim; i++){
+		scale.append(this->vars[i] == t*this->vars[i]);
+	}
+	for(int k=0; k<(signed)this->params.nops(); k++){
+		para_scale.append(this->params[k] == u*this->params[k]);
+	}
+
+	lst fj = this->dyns;
+	for(int j=1; j<=this->options.lookahead; j++){
+
+		if( j > 1 ){	// f^j = f(f^(j-1))
+			lst sub;
+			for(int i=0; i<dim; i++){
+				sub.append(this->vars[i] == fj[i]);
+			}
+			lst next;
+			for(int i=0; i<dim; i++){
+				next.append(this->dyns[i].subs(sub).expand());
+			}
+			fj = next;
+		}
+
+		lst kept, rems;
+		for(int i=0; i<dim; i++){
+			ex fji = fj[i].expand();
+			ex rem = 0;
+			if( this->options.lookahead_degree > 0 ){	// truncate the total degree
+				ex scaled = fji.subs(scale).expand();
+				ex low = 0;
+				for(int d=0; d<=this->options.lookahead_degree; d++){
+					low = low + scaled.coeff(t,d);
+				}
+				rem = (fji - low).expand();
+				fji = low;
+			}
+			if( this->params.nops() > 0 ){	// the control points must be affine in the parameters
+				ex para_scaled = fji.subs(para_scale).expand();
+				ex affine = (para_scaled.coeff(u,0) + para_scaled.coeff(u,1)).expand();
+				rem = (rem + fji - affine).expand();
+				fji = affine;
+			}
+			kept.append(fji);
+			rems.append(rem);
+		}
+		this->lookaheadDyns.push_back(kept);
+
+		// the remainders are bounded at each step: keep them in numerical form
+		lst syms;
+		for(int i=0; i<dim; i++){
+			syms.append(this->vars[i]);
+		}
+		for(int k=0; k<(signed)this->params.nops(); k++){
+			syms.append(this->params[k]);
+		}
+		vector< compact_poly > compact_rems;
+		for(int i=0; i<dim; i++){
+			compact_rems.push_back(ControlPointCache::compress(rems[i],syms,syms.nops()));
+		}
+		this->lookaheadRems.push_back(compact_rems);
+	}
+
+	for(int j=0; j<2*this->options.lookahead; j++){	// non-parametric and parametric
+		this->lookaheadControlPts.push_back(new ControlPointCache((long long)(this->options.cache_mb*1024*1024)));
+	}
+	for(int i=0; i<dim; i++){
+		ostringstream name;
+		name<<"ld"<<i+1;
+		this->lookaheadDeltas.append(symbol(name.str()));
+	}
+}
+
+/**
+ * Bound a polynomial over a box by interval arithmetic on its monomials
+ *
+ * @param[in] e polynomial in the variables followed by the parameters
+ * @param[in] lb lower bounds of the symbols
+ * @param[in] ub upper bounds of the symbols
+ * @param[out] lo lower bound of e
+ * @param[out] hi upper bound of e
+ */
+void Sapo::intervalBound(const compact_poly &e, vector<double> &lb, vector<double> &ub, double &lo, double &hi){
+
+	lo = 0;
+	hi = 0;
+	if( e.coeffs.empty() ){
+		return;
+	}
+
+	int n = e.exps.size()/e.coeffs.size();
+	for(int t=0; t<(signed)e.coeffs.size(); t++){
+
+		const unsigned char *exps = &e.exps[t*n];
+		double tlo = 1, thi = 1;
+		for(int k=0; k<n; k++){
+			int d = exps[k];
+			if( d == 0 ){
+				continue;
+			}
+			if( k >= (signed)lb.size() ){
+				cout<<"Sapo::intervalBound : no bounds for the symbol "<<k;
+				exit (EXIT_FAILURE);
+			}
+			double plo = 1, phi = 1;	// interval of syms[k]^d
+			for(int m=0; m<d; m++){
+				plo = plo*lb[k];
+				phi = phi*ub[k];
+			}
+			if( d % 2 == 0 ){
+				double pmax = max(plo,phi);
+				plo = (lb[k] <= 0 && ub[k] >= 0) ? 0 : min(plo,phi);
+				phi = pmax;
+			}
+			double p1 = tlo*plo, p2 = tlo*phi, p3 = thi*plo, p4 = thi*phi;
+			tlo = min(min(p1,p2),min(p3,p4));
+			thi = max(max(p1,p2),max(p3,p4));
+		}
+		double c = e.coeffs[t];
+		lo += c > 0 ? c*tlo : c*thi;
+		hi += c > 0 ? c*thi : c*tlo;
+	}
+}
+
+/**
+ * Transform a bundle with the composed dynamics f^h at once
+ *
+ * @param[in] X bundle to transform
+ * @param[in] paraSet set of parameters (NULL for the non-parametric transformation)
+ * @param[in] h number of steps
+ * @returns bundles of the steps 1,...,h (options.lookahead_inter) or of the step h only
+ */
+vector< Bundle* > Sapo::lookaheadTransform(Bundle *X, LinearSystem *paraSet, int h){
+
+	this->initLookahead();
+
+	int dim = this->vars.nops();
+	bool truncated = false;		// some f^j has a remainder (truncated degree or non-affine in the parameters)
+	for(int j=0; j<(signed)this->lookaheadRems.size(); j++){
+		for(int i=0; i<dim; i++){
+			truncated = truncated || !this->lookaheadRems[j][i].coeffs.empty();
+		}
+	}
+
+	// bounding box of the bundle (and of the parameters) for the remainders
+	vector< double > lb, ub;
+	if( truncated ){
+		LinearSystem *B = X->getBundle();
+		B->boundingBox(lb,ub);
+		delete B;
+		if( paraSet != NULL ){
+			vector< double > para_lb, para_ub;
+			paraSet->boundingBox(para_lb,para_ub);
+			lb.insert(lb.end(),para_lb.begin(),para_lb.end());
+			ub.insert(ub.end(),para_ub.begin(),para_ub.end());
+		}
+	}
+
+	vector< Bundle* > res;
+	for(int j = this->options.lookahead_inter ? 1 : h; j<=h; j++){
+
+		disturbance_box *rem = NULL;
+		if( truncated ){	// remainders as additive disturbances
+			rem = new disturbance_box();
+			rem->deltas = this->lookaheadDeltas;
+			rem->additive = vector< bool > (dim,true);
+			rem->D = vector< vector< double > > (dim,vector< double > (dim,0));
+			rem->lb = vector< double > (dim);
+			rem->ub = vector< double > (dim);
+			for(int i=0; i<dim; i++){
+				rem->D[i][i] = 1;
+				this->intervalBound(this->lookaheadRems[j-1][i],lb,ub,rem->lb[i],rem->ub[i]);
+			}
+		}
+
+		if( paraSet == NULL ){
+			res.push_back(X->transform(this->vars,this->lookaheadDyns[j-1],this->lookaheadControlPts[j-1],this->options.trans,rem));
+		}else{
+			res.push_back(X->transform(this->vars,this->params,this->lookaheadDyns[j-1],paraSet,this->lookaheadControlPts[this->options.lookahead+j-1],this->options.trans,rem));
+		}
+		delete rem;
+	}
+	return res;
+}
+
+/**
+ * Bounds of a bundle whose directions are all axis-aligned (a box)
+ *
+ * @param[in] X bundle
+ * @param[out] lo lower bounds of the variables
+ * @param[out] hi upper bounds of the variables
+ * @returns false if X is not a box
+ */
+bool Sapo::boxBounds(Bundle *X, vector<double> &lo, vector<double> &hi){
+
+	int dim = X->getDim();
+	lo = vector<double> (dim,-DBL_MAX);
+	hi = vector<double> (dim,DBL_MAX);
+	vector< vector< double > > L = X->getDirections();
+	for(int i=0; i<(signed)L.size(); i++){
+		int axis = -1;
+		for(int j=0; j<dim; j++){
+			if( L[i][j] != 0 ){
+				if( axis >= 0 ){
+					return false;
+				}
+				axis = j;
+			}
+		}
+		if( axis < 0 ){
+			return false;
+		}
+		double a = L[i][axis];
+		double ub = a > 0 ? X->getOffp(i)/a : -X->getOffm(i)/a;
+		double lb = a > 0 ? -X->getOffm(i)/a : X->getOffp(i)/a;
+		lo[axis] = max(lo[axis],lb);
+		hi[axis] = min(hi[axis],ub);
+	}
+	for(int j=0; j<dim; j++){
+		if( lo[j] == -DBL_MAX || hi[j] == DBL_MAX ){
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Compile the dynamics and the Bernstein coefficients of their partial
+ * derivatives over a box lo + alpha*w, alpha \in [0,1]^n, as polynomials in
+ * lo and w
+ */
+void Sapo::initMonotone(){
+
+	if( !this->monotoneDyns.empty() ){
+		return;
+	}
+
+	int dim = this->vars.nops();
+	lst lo, w, alpha, box_syms, sub;
+	for(int j=0; j<dim; j++){
+		ostringstream lname, wname, aname;
+		lname<<"ml"<<j+1;
+		wname<<"mw"<<j+1;
+		aname<<"ma"<<j+1;
+		lo.append(symbol(lname.str()));
+		w.append(symbol(wname.str()));
+		alpha.append(symbol(aname.str()));
+	}
+	for(int j=0; j<dim; j++){
+		box_syms.append(lo[j]);
+		sub.append(this->vars[j] == lo[j] + alpha[j]*w[j]);
+	}
+	for(int j=0; j<dim; j++){
+		box_syms.append(w[j]);
+	}
+
+	for(int i=0; i<dim; i++){
+
+		compact_points fi;
+		fi.num_syms = dim;
+		fi.num_vals = dim;
+		fi.polys.push_back(ControlPointCache::compress(this->dyns[i],this->vars,dim));
+		this->monotoneDyns.push_back(fi);
+
+		vector< compact_points > row;
+		for(int j=0; j<dim; j++){
+			compact_points dij;
+			dij.num_syms = 2*dim;
+			dij.num_vals = 2*dim;
+			ex d = this->dyns[i].diff(ex_to<symbol>(this->vars[j])).subs(sub).expand();
+			if( !d.is_zero() ){
+				BaseConverter *BC = new BaseConverter(alpha,d);
+				lst coeffs = BC->getBernCoeffsMatrix();
+				delete BC;
+				for (lst::const_iterator c = coeffs.begin(); c != coeffs.end(); ++c){
+					dij.polys.push_back(ControlPointCache::compress(*c,box_syms,2*dim));
+				}
+			}
+			row.push_back(dij);
+		}
+		this->monotoneJac.push_back(row);
+	}
+}
+
+/**
+ * Transform a box by corner propagation. When the Bernstein coefficients of
+ * df_i/dx_j over the box have constant sign for all j, f_i is monotone in
+ * each variable on the box and its extrema are at the two corners selected
+ * by the sign pattern, so the image box is exact
+ *
+ * @param[in] X bundle to transform
+ * @returns transformed bundle (NULL if X is not a box or the certificate fails)
+ */
+Bundle* Sapo::monotoneTransform(Bundle *X){
+
+	if( this->dists != NULL || !this->modeDyns.empty() || !X->getZonotopes().empty() ){
+		return NULL;
+	}
+	ex dyns = this->dyns;
+	for(int k=0; k<(signed)this->params.nops(); k++){
+		if( dyns.has(this->params[k]) ){
+			return NULL;
+		}
+	}
+
+	int dim = this->vars.nops();
+	vector<double> lo, hi;
+	if( !this->boxBounds(X,lo,hi) ){
+		return NULL;
+	}
+	this->initMonotone();
+
+	vector<double> box (lo);
+	for(int j=0; j<dim; j++){
+		box.push_back(hi[j] - lo[j]);
+	}
+
+	// certify the sign pattern of the Jacobian and select the corners
+	vector<double> new_lo (dim), new_hi (dim);
+	for(int i=0; i<dim; i++){
+		vector<double> corner_lo (lo), corner_hi (hi);
+		for(int j=0; j<dim; j++){
+			vector< vector< double > > coeffs = ControlPointCache::evaluate(this->monotoneJac[i][j],box);
+			double cmin = 0, cmax = 0;
+			for(int c=0; c<(signed)coeffs.size(); c++){
+				cmin = min(cmin,coeffs[c][0]);
+				cmax = max(cmax,coeffs[c][0]);
+			}
+			if( cmin < 0 && cmax > 0 ){		// not certified: fall back to the Bernstein transformation
+				if(Logger::enabled(LOG_DEBUG)){
+					ostringstream msg;
+					msg<<"corner propagation: sign of df"<<i+1<<"/dx"<<j+1<<" not certified";
+					Logger::log(LOG_DEBUG,msg.str());
+				}
+				return NULL;
+			}
+			if( cmax <= 0 ){	// non-increasing in x_j
+				corner_lo[j] = hi[j];
+				corner_hi[j] = lo[j];
+			}
+		}
+		new_lo[i] = ControlPointCache::evaluate(this->monotoneDyns[i],corner_lo)[0][0];
+		new_hi[i] = ControlPointCache::evaluate(this->monotoneDyns[i],corner_hi)[0][0];
+	}
+
+	// offsets of the axis-aligned directions
+	vector< vector< double > > L = X->getDirections();
+	vector<double> offp (L.size()), offm (L.size());
+	for(int i=0; i<(signed)L.size(); i++){
+		for(int j=0; j<dim; j++){
+			if( L[i][j] != 0 ){
+				offp[i] = max(L[i][j]*new_lo[j],L[i][j]*new_hi[j]);
+				offm[i] = max(-L[i][j]*new_lo[j],-L[i][j]*new_hi[j]);
+			}
+		}
+	}
+
+	Bundle *res = new Bundle(*X);
+	res->setOffsetP(offp);
+	res->setOffsetM(offm);
+	this->monotone_steps++;
+
+	return res;
+}
+
+/**
+ * Initialize the piecewise dynamics: check the modes and allocate the caches
+ * of their control points
+ *
+ * @param[in] model model with the piecewise dynamics
+ */
+void Sapo::initPiecewise(Model *model){
+
+	this->modeDyns = model->getModeDyns();
+	this->modeGuards = model->getModeGuards();
+
+	if( this->modeGuards.size() != this->modeDyns.size() ){
+		cout<<"Sapo::initPiecewise : each mode must have its guards";
+		exit (EXIT_FAILURE);
+	}
+	for(int m=0; m<(signed)this->modeDyns.size(); m++){
+		if( this->modeDyns[m].nops() != this->vars.nops() ){
+			cout<<"Sapo::initPiecewise : the dynamics of each mode must have "<<this->vars.nops()<<" components";
+			exit (EXIT_FAILURE);
+		}
+		ex guards = this->modeGuards[m];
+		for(int k=0; k<(signed)this->params.nops(); k++){
+			if( guards.has(this->params[k]) ){
+				cout<<"Sapo::initPiecewise : the guards cannot depend on the parameters";
+				exit (EXIT_FAILURE);
+			}
+		}
+	}
+	if( this->dists != NULL || this->options.lookahead > 1 ){
+		cout<<"Sapo::initPiecewise : piecewise dynamics do not support disturbances and lookahead";
+		exit (EXIT_FAILURE);
+	}
+
+	for(int m=0; m<2*(signed)this->modeDyns.size(); m++){
+		this->modeControlPts.push_back(new ControlPointCache((long long)(this->options.cache_mb*1024*1024)));
+	}
+	this->guardControlPts = new ControlPointCache((long long)(this->options.cache_mb*1024*1024));
+}
+
+/**
+ * Transform a bundle with the piecewise dynamics: the modes whose guards are
+ * certainly violated on the bundle are skipped
+ *
+ * @param[in] X bundle to transform
+ * @param[in] paraSet set of parameters (NULL for the non-parametric transformation)
+ * @returns transformed bundle
+ */
+Bundle* Sapo::piecewiseTransform(Bundle *X, LinearSystem *paraSet){
+
+	int num_modes = this->modeDyns.size();
+	vector< ControlPointCache* > controlPts (this->modeControlPts.begin() + (paraSet == NULL ? 0 : num_modes),
+			this->modeControlPts.begin() + (paraSet == NULL ? num_modes : 2*num_modes));
+
+	int num_active;
+	Bundle *res = X->transform(this->vars,this->params,this->modeDyns,this->modeGuards,paraSet,controlPts,
+			this->guardControlPts,this->options.trans,num_active);
+
+	this->piecewise_steps++;
+	this->active_modes += num_active;
+	if(Logger::enabled(LOG_DEBUG)){
+		ostringstream msg;
+		msg<<"piecewise dynamics: "<<num_active<<" active modes";
+		Logger::log(LOG_DEBUG,msg.str());
+	}
+	return res;
+}
+
 /**
  * Parameter synthesis procedure
  *
@@ -117,11 +776,37 @@ Flowpipe* Sapo::reach(Bundle* initSet, LinearSystem* paraSet, int k){
  */
 LinearSystemSet* Sapo::synthesize(Bundle *reachSet, LinearSystemSet *parameterSet, STL *formula){
 
-	cout<<"Synthesizing parameters..."<<flush;
+	if( !this->modeDyns.empty() ){
+		cout<<"Sapo::synthesize : the parameter synthesis does not support piecewise dynamics";
+		exit (EXIT_FAILURE);
+	}
+
+	cout<<"Synthesizing parameters...";
+
+	if(this->options.perf_counters){	// report this analysis only
+		PerfCounters::reset();
+	}
 
 	clock_t tStart = clock();
+	MemoryScope mem(SYNTHESIS_SETS);
 	LinearSystemSet *res = this->synthesizeSTL(reachSet,parameterSet,formula);
 	cout<<"Done.\tTime taken: "<<double(clock() - tStart) / CLOCKS_PER_SEC<<"\n";
+	if(Logger::enabled(LOG_INFO) && this->refine_calls > 0){
+		ostringstream msg;
+		msg<<"parameter refinement ("<<(this->options.refine_intersect ? "intersection" : "union")<<"): ";
+		msg<<this->refine_calls<<" refinements, "<<this->refine_in<<" input sets, "<<this->refine_out<<" refined sets";
+		Logger::log(LOG_INFO,msg.str());
+	}
+	Logger::flush();
+
+	if(this->options.perf_counters){
+		PerfCounters::report(cout);
+	}
+	if(this->options.mem_report){
+		MemoryTracker::report(cout);
+		this->reachControlPts->report(cout,"reach");
+		this->synthControlPts->report(cout,"synthesis");
+	}
 
 	return res;
 }
@@ -192,7 +877,11 @@ LinearSystemSet* Sapo::synthesizeSTL(Bundle *reachSet, LinearSystemSet *paramete
  */
 LinearSystemSet* Sapo::refineParameters(Bundle *reachSet, LinearSystemSet *parameterSet, STL *sigma){
 
-	LinearSystemSet *result = new LinearSystemSet();
+	// preparation stage (single-threaded): all the symbolic work, resulting in
+	// the compact control points and the atom at the base vertex of each parallelotope
+	vector< shared_ptr<const compact_points> > controlPts;
+	vector< vector< double > > values;
+	vector< vector< double > > vertex_rows;		// constant term and coefficients of the parameters (empty if not affine)
 
 	for(int i=0; i<reachSet->getCard(); i++){	// for each parallelotope
 
@@ -202,10 +891,16 @@ LinearSystemSet* Sapo::refineParameters(Bundle *reachSet, LinearSystemSet *param
 
 		Parallelotope *P = reachSet->getParallelotope(i);
 		lst genFun = P->getGeneratorFunction();
-		lst controlPts;
 
-		if(this->synthControlPts.count(key) == 0 || (!this->synthControlPts[key].first.is_equal(genFun))){
+		// values of the base vertex and of the lengths
+		vector< double > base_vertex = P->getBaseVertex();
+		vector< double > lengths = P->getLenghts();
+		values.push_back(base_vertex);
+		values.back().insert(values.back().end(),lengths.begin(),lengths.end());
 
+		if( !this->synthControlPts->contains(key,genFun) ){
+
+			MemoryScope mem(BERNSTEIN_CACHE);
 
 			// compose f(gamma(x))
 			lst sub, fog;
@@ -213,7 +908,7 @@ LinearSystemSet* Sapo::refineParameters(Bundle *reachSet, LinearSystemSet *param
 				sub.append(vars[j] == genFun[j]);
 			}
 			for(int j=0; j<(signed)vars.nops(); j++){
-				fog.append(this->dyns[j].subs(sub));
+				fog.append(this->synth_dyns[j].subs(sub));
 			}
 
 			// compose sigma(f(gamma(x)))
@@ -225,44 +920,227 @@ LinearSystemSet* Sapo::refineParameters(Bundle *reachSet, LinearSystemSet *param
 			sofog = sigma->getPredicate().subs(sub_sigma);
 
 			// compute the Bernstein control points
-			BaseConverter *bc = new BaseConverter(P->getAlpha(),sofog);
-			controlPts = bc->getBernCoeffsMatrix();
-			this->synthControlPts[key].first = genFun;
-			this->synthControlPts[key].second = controlPts;
+			lst bern_vars = P->getAlpha();	// the atom must hold for all the disturbances
+			if( this->dists != NULL ){
+				for(int j=0; j<(signed)this->dists->deltas.nops(); j++){
+					bern_vars.append(this->dists->deltas[j]);
+				}
+			}
+			BaseConverter *bc = new BaseConverter(bern_vars,sofog);
 
-		}else{
-			controlPts = this->synthControlPts[key].second;
+			lst syms;
+			for(int j=0; j<this->vars.nops(); j++){
+				syms.append(P->getQ()[j]);
+			}
+			for(int j=0; j<this->vars.nops(); j++){
+				syms.append(P->getBeta()[j]);
+			}
+			for(int j=0; j<(signed)this->params.nops(); j++){
+				syms.append(this->params[j]);
+			}
+			this->synthControlPts->insert(key,genFun,syms,values.back().size(),bc->getBernCoeffsMatrix());
 		}
+		controlPts.push_back(this->synthControlPts->find(key));	// kept alive even if evicted by a later insertion
 
-		// substitute numerical values in sofog
-		vector< double > base_vertex = P->getBaseVertex();
-		vector< double > lengths = P->getLenghts();
-
-		lst qvars = P->getQ();
-		lst bvars = P->getBeta();
-		lst para_sub;
+		// atom at the base vertex (the control point of alpha = 0, delta = 0)
+		lst vertex_sub;
 		for(int j=0; j<this->vars.nops(); j++){
-			para_sub.append(qvars[j] == base_vertex[j]);
-			para_sub.append(bvars[j] == lengths[j]);
+			vertex_sub.append(vars[j] == base_vertex[j]);
+		}
+		if( this->dists != NULL ){
+			for(int j=0; j<(signed)this->dists->deltas.nops(); j++){
+				vertex_sub.append(this->dists->deltas[j] == 0);
+			}
+		}
+		lst sub_sigma;
+		for(int j=0; j<this->vars.nops(); j++){
+			sub_sigma.append(vars[j] == this->synth_dyns[j].subs(vertex_sub));
+		}
+		vertex_rows.push_back(vector< double > ());
+		if( !this->affineRow(sigma->getPredicate().subs(sub_sigma),vertex_rows.back()) ){
+			vertex_rows.back().clear();
+		}
+	}
+
+	// numerical stage: bounding boxes of the parameter sets (used by the quick check)
+	vector<LinearSystem*> paraSets = parameterSet->getSet();
+	vector< vector< double > > para_lb (paraSets.size()), para_ub (paraSets.size());
+	for(int j=0; j<(signed)paraSets.size(); j++){
+		paraSets[j]->boundingBox(para_lb[j],para_ub[j]);
+	}
+
+	// numerical stage: decide each parameter set and collect the constraints of each parallelotope
+	int card = controlPts.size();
+	int num_sets = paraSets.size();
+	vector< vector<int> > status (card,vector<int> (num_sets));	// 1: the atom holds, 0: undecided, -1: violated
+	vector< vector< vector< double > > > A (card);
+	vector< vector< double > > b (card);
+	ThreadPool::shared()->parallelFor(card,[&](int i){
+
+		// numerical control points: constant term and coefficients of the parameters
+		vector< vector< double > > synth_controlPts = ControlPointCache::evaluate(*controlPts[i],values[i]);
+
+		// quick check: keep the parameter sets where all the control points are
+		// non-positive, drop those where the atom fails at the base vertex
+		bool undecided = false;
+		for(int j=0; j<num_sets; j++){
+			status[i][j] = this->quickCheck(synth_controlPts,vertex_rows[i],para_lb[j],para_ub[j]);
+			undecided = undecided || status[i][j] == 0;
+		}
+
+		if( undecided ){
+			// control point c0 + c*p <= 0 becomes c*p <= -c0 (duplicates removed)
+			set< vector< double > > rows;
+			for(int j=0; j<(signed)synth_controlPts.size(); j++){
+				if( rows.insert(synth_controlPts[j]).second ){
+					A[i].push_back(vector< double > (synth_controlPts[j].begin()+1,synth_controlPts[j].end()));
+					b[i].push_back(-synth_controlPts[j][0]);
+				}
+			}
+		}
+	});
+
+	LinearSystemSet *result;
+	if( this->options.refine_intersect ){	// one system for each parameter set with the constraints of all the parallelotopes
+
+		vector< LinearSystem* > constraintLS (card,(LinearSystem*)NULL);
+		for(int i=0; i<card; i++){
+			if( !A[i].empty() ){
+				constraintLS[i] = new LinearSystem(A[i],b[i]);
+			}
+		}
+
+		vector< LinearSystem* > candidates (num_sets,(LinearSystem*)NULL);
+		for(int j=0; j<num_sets; j++){
+			LinearSystem *LS = paraSets[j];
+			for(int i=0; i<card && LS != NULL; i++){
+				LinearSystem *next = LS;
+				if( status[i][j] == -1 ){
+					next = NULL;
+				}else if( status[i][j] == 0 ){
+					next = LS->appendLinearSystem(constraintLS[i]);
+				}
+				if( next != LS && LS != paraSets[j] ){	// intermediate system (the blocks are shared)
+					delete LS;
+				}
+				LS = next;
+			}
+			candidates[j] = LS;
 		}
-		ex num_sofog;
-		lst synth_controlPts;
-		//for(int j=0; j<controlPts.nops(); j++){
-		for (lst::const_iterator j = controlPts.begin(); j != controlPts.end(); ++j){
-			synth_controlPts.append((*j).subs(para_sub));
+		for(int i=0; i<card; i++){
+			delete constraintLS[i];
 		}
 
-		//cout<<synth_controlPts;
+		// check their emptiness in parallel
+		vector<char> empty (num_sets);
+		ThreadPool::shared()->parallelFor(num_sets,[&](int j){
+			empty[j] = candidates[j] == NULL || candidates[j]->isEmpty();
+		});
+		vector< LinearSystem* > refined;
+		for(int j=0; j<num_sets; j++){
+			if( !empty[j] ){
+				refined.push_back(candidates[j]);
+			}else if( candidates[j] != paraSets[j] ){
+				delete candidates[j];
+			}
+		}
+		result = new LinearSystemSet(refined);
+
+	}else{	// union of the refinements of each parallelotope
+
+		result = new LinearSystemSet();
 
-		LinearSystem *num_constraintLS = new LinearSystem(this->params, synth_controlPts);
-		LinearSystemSet *controlPtsLS = new LinearSystemSet(num_constraintLS);
-		result = result->unionWith(parameterSet->intersectWith(controlPtsLS));
+		for(int i=0; i<card; i++){
+			vector<LinearSystem*> satisfied, undecided;
+			for(int j=0; j<num_sets; j++){
+				if( status[i][j] == 1 ){
+					satisfied.push_back(paraSets[j]);
+				}else if( status[i][j] == 0 ){
+					undecided.push_back(paraSets[j]);
+				}
+			}
+			result = result->unionWith(new LinearSystemSet(satisfied));
+			if( !undecided.empty() ){
+				LinearSystem *num_constraintLS = new LinearSystem(A[i],b[i]);
+				LinearSystemSet *controlPtsLS = new LinearSystemSet(num_constraintLS);
+				result = result->unionWith((new LinearSystemSet(undecided))->intersectWith(controlPtsLS));
+			}
+		}
 	}
 
+	this->refine_calls++;
+	this->refine_in += num_sets;
+	this->refine_out += result->size();
+
 	return result;
 
 }
 
+/**
+ * Coefficients of an affine function of the parameters
+ *
+ * @param[in] e affine expression in the parameters
+ * @param[out] row constant term followed by the coefficients of the parameters
+ * @returns false if e is not affine in the parameters
+ */
+bool Sapo::affineRow(ex e, vector<double> &row){
+
+	ex const_term = e.expand();
+	row = vector<double> (1 + this->params.nops(),0);
+	for(int k=0; k<(signed)this->params.nops(); k++){
+		ex coeff = const_term.coeff(this->params[k],1);
+		if( const_term.degree(this->params[k]) > 1 || !is_a<numeric>(evalf(coeff)) ){
+			return false;
+		}
+		row[k+1] = ex_to<numeric>(evalf(coeff)).to_double();
+		const_term = const_term.coeff(this->params[k],0);
+	}
+	if( !is_a<numeric>(evalf(const_term)) ){
+		return false;
+	}
+	row[0] = ex_to<numeric>(evalf(const_term)).to_double();
+
+	return true;
+}
+
+/**
+ * Decide an atom on a parameter set without solving linear programs.
+ * The atom holds if the maximum of every control point over the bounding
+ * box of the parameter set is non-positive. It is violated if the atom is
+ * positive at the base vertex for all the parameters of the box (the base
+ * vertex is the control point of alpha = 0, so the refinement would return
+ * an empty set)
+ *
+ * @param[in] controlPts control points of the atom (constant term and coefficients of the parameters)
+ * @param[in] vertex_row atom at the base vertex of the parallelotope (constant term and coefficients of the parameters, empty if not affine)
+ * @param[in] lb lower bounds of the parameter set
+ * @param[in] ub upper bounds of the parameter set
+ * @returns 1 if the atom holds, -1 if it is violated, 0 if undecided
+ */
+int Sapo::quickCheck(const vector< vector< double > > &controlPts, const vector< double > &vertex_row, const vector<double> &lb, const vector<double> &ub){
+
+	if( !vertex_row.empty() ){
+		double min = vertex_row[0];
+		for(int k=1; k<(signed)vertex_row.size(); k++){
+			min += vertex_row[k]*(vertex_row[k] > 0 ? lb[k-1] : ub[k-1]);
+		}
+		if( min > 0 ){
+			return -1;
+		}
+	}
+
+	for(int j=0; j<(signed)controlPts.size(); j++){
+		double max = controlPts[j][0];
+		for(int k=1; k<(signed)controlPts[j].size(); k++){
+			max += controlPts[j][k]*(controlPts[j][k] > 0 ? ub[k-1] : lb[k-1]);
+		}
+		if( max > 0 ){
+			return 0;
+		}
+	}
+	return 1;
+}
+
 /**
  * Parameter synthesis w.r.t. an until formula
  *
@@ -358,7 +1236,7 @@ LinearSystemSet* Sapo::synthesizeAlways(Bundle *reachSet, LinearSystemSet *param
 
 		// Reach step wrt to the i-th linear system of parameterSet
 		for(int i=0; i<parameterSet->size(); i++){
-			Bundle *newReachSet = reachSet->transform(this->vars,this->params,this->dyns,parameterSet->at(i), this->reachControlPts, options.trans);
+			Bundle *newReachSet = reachSet->transform(this->vars,this->params,this->dyns,parameterSet->at(i), this->reachControlPts, options.trans, this->dists);
 			LinearSystemSet* tmpLSset = new LinearSystemSet(parameterSet->at(i));
 			tmpLSset = synthesizeAlways(newReachSet, tmpLSset, formula);
 			result = result->unionWith(tmpLSset);
@@ -379,7 +1257,7 @@ LinearSystemSet* Sapo::synthesizeAlways(Bundle *reachSet, LinearSystemSet *param
 
 			// Reach step wrt to the i-th linear system of P
 			for(int i=0; i<P->size(); i++){
-				Bundle *newReachSet = reachSet->transform(this->vars,this->params,this->dyns,P->at(i), this->reachControlPts, options.trans);
+				Bundle *newReachSet = reachSet->transform(this->vars,this->params,this->dyns,P->at(i), this->reachControlPts, options.trans, this->dists);
 				LinearSystemSet* tmpLSset = new LinearSystemSet(P->at(i));
 				tmpLSset = synthesizeAlways(newReachSet, tmpLSset, formula);
 				result = result->unionWith(tmpLSset);
@@ -402,5 +1280,13 @@ LinearSystemSet* Sapo::synthesizeAlways(Bundle *reachSet, LinearSystemSet *param
 
 
 Sapo::~Sapo() {
-	// TODO Auto-generated destructor stub
+	delete this->reachControlPts;
+	delete this->synthControlPts;
+	for(int j=0; j<(signed)this->lookaheadControlPts.size(); j++){
+		delete this->lookaheadControlPts[j];
+	}
+	for(int m=0; m<(signed)this->modeControlPts.size(); m++){
+		delete this->modeControlPts[m];
+	}
+	delete this->guardControlPts;
 }
@@ -0,0 +1,105 @@
+/**
+ * @file SparseMatrix.cpp
+ * Construction of the CSR arrays, row products, and angles between rows
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "SparseMatrix.h"
+
+#include <algorithm>
+
+/**
+ * Constructor that instantiates an empty matrix
+ */
+SparseMatrix::SparseMatrix(){
+	this->num_cols = 0;
+	this->row_ptr.push_back(0);
+}
+
+/**
+ * Constructor that compresses a dense matrix
+ *
+ * @param[in] M dense matrix
+ */
+SparseMatrix::SparseMatrix(vector< vector< double > > M){
+
+	this->num_cols = M.empty() ? 0 : M[0].size();
+	this->row_ptr.push_back(0);
+
+	for(int i=0; i<(signed)M.size(); i++){
+		for(int j=0; j<(signed)M[i].size(); j++){
+			if( M[i][j] != 0 ){
+				this->cols.push_back(j);
+				this->vals.push_back(M[i][j]);
+			}
+		}
+		this->row_ptr.push_back(this->vals.size());
+	}
+}
+
+/**
+ * Product of a row and a dense vector
+ *
+ * @param[in] i row index
+ * @param[in] x dense vector
+ * @returns M[i]*x
+ */
+double SparseMatrix::dot(int i, const vector< double > &x){
+	double res = 0;
+	for(int p=this->row_ptr[i]; p<this->row_ptr[i+1]; p++){
+		res += this->vals[p]*x[this->cols[p]];
+	}
+	return res;
+}
+
+/**
+ * Product of two rows (merge of the sorted column indexes)
+ *
+ * @param[in] i first row index
+ * @param[in] j second row index
+ * @returns M[i]*M[j]
+ */
+double SparseMatrix::dot(int i, int j){
+
+	double res = 0;
+	int p = this->row_ptr[i], q = this->row_ptr[j];
+	while( p < this->row_ptr[i+1] && q < this->row_ptr[j+1] ){
+		if( this->cols[p] < this->cols[q] ){
+			p++;
+		}else if( this->cols[p] > this->cols[q] ){
+			q++;
+		}else{
+			res += this->vals[p]*this->vals[q];
+			p++;
+			q++;
+		}
+	}
+	return res;
+}
+
+/**
+ * Euclidean norm of a row
+ *
+ * @param[in] i row index
+ * @returns norm of M[i]
+ */
+double SparseMatrix::norm(int i){
+	return sqrt(this->dot(i,i));
+}
+
+/**
+ * Orthogonal proximity of two rows, i.e., how close the angle between them
+ * is to pi/2 (pi/2 for a row and itself). The cosine is clamped to [-1,1]
+ * against rounding errors
+ *
+ * @param[in] i first row index
+ * @param[in] j second row index
+ * @returns orthogonal proximity
+ */
+double SparseMatrix::orthProx(int i, int j){
+	double c = this->dot(i,j)/(this->norm(i)*this->norm(j));
+	c = max(-1.0,min(1.0,c));
+	return fabs(acos(c) - (3.14159265/2));
+}
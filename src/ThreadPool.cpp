@@ -0,0 +1,190 @@
+/**
+ * @file ThreadPool.cpp
+ * Workers of the pool and the dynamic assignment of the iterations of a
+ * parallelFor
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "ThreadPool.h"
+
+ThreadPool* ThreadPool::pool = NULL;
+mutex ThreadPool::pool_lock;
+
+static thread_local bool in_pool = false;	// the calling thread is executing a job
+
+/**
+ * Constructor that starts the workers
+ *
+ * @param[in] num_threads total number of threads (the submitting thread included)
+ */
+ThreadPool::ThreadPool(int num_threads){
+
+	this->num_iters = 0;
+	this->next_iter = 0;
+	this->running = 0;
+	this->job_id = 0;
+	this->tag = UNTAGGED;
+	this->stop = false;
+
+	for(int i=1; i<num_threads; i++){
+		this->workers.push_back(thread(&ThreadPool::work,this));
+	}
+}
+
+/**
+ * Set the number of threads of the shared pool
+ *
+ * @param[in] num_threads total number of threads (<=0: one for each core)
+ */
+void ThreadPool::setThreads(int num_threads){
+
+	if( num_threads <= 0 ){
+		num_threads = max(1,(int)thread::hardware_concurrency());
+	}
+
+	lock_guard<mutex> guard(pool_lock);
+	if( pool != NULL ){
+		if( pool->size() == num_threads ){
+			return;
+		}
+		delete pool;
+	}
+	pool = new ThreadPool(num_threads);
+}
+
+/**
+ * Get the shared pool (single threaded if never set)
+ *
+ * @returns shared pool
+ */
+ThreadPool* ThreadPool::shared(){
+
+	lock_guard<mutex> guard(pool_lock);
+	if( pool == NULL ){
+		pool = new ThreadPool(1);
+	}
+	return pool;
+}
+
+/**
+ * Stop the shared pool and join its workers. A forked child inherits only
+ * the forking thread: the pool is stopped before forking so that the child
+ * does not find a pool whose workers (and locks) are gone. The next call to
+ * shared or setThreads starts a new pool
+ */
+void ThreadPool::stopShared(){
+
+	lock_guard<mutex> guard(pool_lock);
+	if( pool != NULL ){
+		delete pool;
+		pool = NULL;
+	}
+}
+
+/**
+ * Loop of the workers
+ */
+void ThreadPool::work(){
+
+	long seen = 0;
+	in_pool = true;
+
+	while(true){
+
+		unique_lock<mutex> guard(this->lock);
+		this->job_ready.wait(guard,[this,seen]{ return this->stop || this->job_id != seen; });
+		if( this->stop ){
+			return;
+		}
+		seen = this->job_id;
+		mem_tag job_tag = this->tag;
+		guard.unlock();
+
+		{
+			MemoryScope mem(job_tag);	// charge the memory as the submitting thread
+			this->runIterations();
+		}
+
+		guard.lock();
+		this->running--;
+		if( this->running == 0 ){
+			this->job_done.notify_all();
+		}
+	}
+}
+
+/**
+ * Execute iterations of the actual job until none is left
+ */
+void ThreadPool::runIterations(){
+
+	while(true){
+		int k;
+		{
+			lock_guard<mutex> guard(this->lock);
+			if( this->next_iter >= this->num_iters ){
+				return;
+			}
+			k = this->next_iter++;
+		}
+		this->body(k);
+	}
+}
+
+/**
+ * Execute body(0),...,body(n-1) on the threads of the pool.
+ * The submitting thread takes part to the job and returns when all the iterations
+ * are completed. Nested or concurrent submissions are executed sequentially
+ *
+ * @param[in] n number of iterations
+ * @param[in] body body of the iterations
+ */
+void ThreadPool::parallelFor(int n, function<void(int)> body){
+
+	unique_lock<mutex> guard(this->lock, defer_lock);
+	bool sequential = n <= 1 || this->workers.empty() || in_pool;
+	if( !sequential ){
+		guard.lock();
+		sequential = this->running > 0;	// another job is in progress
+	}
+
+	if( sequential ){
+		if( guard.owns_lock() ){
+			guard.unlock();
+		}
+		for(int i=0; i<n; i++){
+			body(i);
+		}
+		return;
+	}
+
+	this->body = body;
+	this->num_iters = n;
+	this->next_iter = 0;
+	this->running = this->workers.size();
+	this->tag = MemoryTracker::getTag();
+	this->job_id++;
+	guard.unlock();
+	this->job_ready.notify_all();
+
+	in_pool = true;
+	this->runIterations();
+	in_pool = false;
+
+	guard.lock();
+	this->job_done.wait(guard,[this]{ return this->running == 0; });
+	this->body = nullptr;
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> guard(this->lock);
+		this->stop = true;
+	}
+	this->job_ready.notify_all();
+	for(int i=0; i<(signed)this->workers.size(); i++){
+		this->workers[i].join();
+	}
+}
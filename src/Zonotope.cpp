@@ -0,0 +1,328 @@
+/**
+ * @file Zonotope.cpp
+ * Support functions in closed form, Girard's order reduction, and the
+ * image of a zonotope through polynomial dynamics
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Zonotope.h"
+
+/**
+ * Constructor that instantiates a zonotope
+ *
+ * @param[in] q base point
+ * @param[in] G generators (one for each row)
+ * @param[in] max_gens maximum number of generators kept by the order reduction
+ */
+Zonotope::Zonotope(vector< double > q, vector< vector< double > > G, int max_gens){
+
+	this->dim = q.size();
+	for(int i=0; i<(signed)G.size(); i++){
+		if( (signed)G[i].size() != this->dim ){
+			cout<<"Zonotope::Zonotope : generators must have "<<this->dim<<" components";
+			exit (EXIT_FAILURE);
+		}
+	}
+	if( max_gens < this->dim ){
+		cout<<"Zonotope::Zonotope : max_gens must be at least "<<this->dim;
+		exit (EXIT_FAILURE);
+	}
+
+	this->q = q;
+	this->G = G;
+	this->max_gens = max_gens;
+
+	for(int i=0; i<(signed)G.size(); i++){
+		ostringstream name;
+		name<<"za"<<i+1;
+		this->alpha.append(symbol(name.str()));
+	}
+}
+
+/**
+ * Constructor that instantiates a zonotope equal to a parallelotope
+ *
+ * @param[in] P parallelotope
+ * @param[in] max_gens maximum number of generators kept by the order reduction
+ */
+Zonotope::Zonotope(Parallelotope *P, int max_gens){
+
+	vector< double > base_vertex = P->getBaseVertex();
+	vector< double > lengths = P->getLenghts();
+	vector< vector< double > > u = P->getVersors();
+
+	this->dim = P->getDim();
+	if( max_gens < this->dim ){
+		cout<<"Zonotope::Zonotope : max_gens must be at least "<<this->dim;
+		exit (EXIT_FAILURE);
+	}
+
+	this->q = base_vertex;
+	this->max_gens = max_gens;
+	for(int i=0; i<this->dim; i++){
+		vector< double > gi (this->dim);
+		for(int j=0; j<this->dim; j++){
+			gi[j] = lengths[i]*u[i][j];
+		}
+		this->G.push_back(gi);
+
+		ostringstream name;
+		name<<"za"<<i+1;
+		this->alpha.append(symbol(name.str()));
+	}
+}
+
+/**
+ * Generator function q + sum_i alpha_i g_i
+ *
+ * @returns list with one expression for each coordinate
+ */
+lst Zonotope::getGeneratorFunction(){
+
+	lst genFun;
+	for(int j=0; j<this->dim; j++){
+		ex xj = this->q[j];
+		for(int i=0; i<this->getNumGens(); i++){
+			if( this->G[i][j] != 0 ){
+				xj = xj + this->alpha[i]*this->G[i][j];
+			}
+		}
+		genFun.append(xj);
+	}
+	return genFun;
+}
+
+/**
+ * Support function in closed form: l*q + sum_i max(0,l*g_i)
+ *
+ * @param[in] l direction
+ * @returns maximum of l*x over the zonotope
+ */
+double Zonotope::support(vector<double> l){
+
+	double res = this->prod(l,this->q);
+	for(int i=0; i<this->getNumGens(); i++){
+		res += max(0.0,this->prod(l,this->G[i]));
+	}
+	return res;
+}
+
+/**
+ * Support function along a sparse row
+ *
+ * @param[in] M sparse matrix
+ * @param[in] i row index
+ * @param[in] sign 1 for M[i], -1 for -M[i]
+ * @returns maximum of sign*M[i]*x over the zonotope
+ */
+double Zonotope::support(SparseMatrix *M, int i, double sign){
+
+	double res = sign*M->dot(i,this->q);
+	for(int k=0; k<this->getNumGens(); k++){
+		res += max(0.0,sign*M->dot(i,this->G[k]));
+	}
+	return res;
+}
+
+/**
+ * Girard's order reduction: keep the max_gens-dim generators with the largest
+ * difference between 1-norm and infinity-norm and box the others
+ *
+ * @returns zonotope with at most max_gens generators containing this one
+ */
+Zonotope* Zonotope::reduceOrder(){
+
+	if( this->getNumGens() <= this->max_gens ){
+		return new Zonotope(this->q,this->G,this->max_gens);
+	}
+
+	vector< pair<double,int> > weights;
+	for(int i=0; i<this->getNumGens(); i++){
+		double norm1 = 0, normInf = 0;
+		for(int j=0; j<this->dim; j++){
+			norm1 += abs(this->G[i][j]);
+			normInf = max(normInf,abs(this->G[i][j]));
+		}
+		weights.push_back(pair<double,int> (norm1 - normInf, i));
+	}
+	sort(weights.begin(),weights.end());
+
+	int num_boxed = this->getNumGens() - (this->max_gens - this->dim);
+	vector< double > newq = this->q;
+	vector< double > widths (this->dim,0);
+	vector< vector< double > > newG;
+
+	for(int k=0; k<(signed)weights.size(); k++){
+		vector< double > &gi = this->G[weights[k].second];
+		if( k < num_boxed ){	// interval hull of alpha_i*g_i
+			for(int j=0; j<this->dim; j++){
+				newq[j] += min(0.0,gi[j]);
+				widths[j] += abs(gi[j]);
+			}
+		}else{
+			newG.push_back(gi);
+		}
+	}
+
+	for(int j=0; j<this->dim; j++){
+		vector< double > box_gen (this->dim,0);
+		box_gen[j] = widths[j];
+		newG.push_back(box_gen);
+	}
+
+	return new Zonotope(newq,newG,this->max_gens);
+}
+
+/**
+ * Over-approximate the image of the zonotope: f(q+G*alpha) is split in its
+ * affine part at alpha=1/2 and a nonlinear remainder bounded monomial by
+ * monomial in the centered variables alpha-1/2 (the cost grows with the
+ * number of terms, not exponentially with the generators as a Bernstein
+ * enclosure would). The affine part gives the new generators, the
+ * remainder bounds give a box that is added to them. Disturbances entering
+ * nonlinearly are treated as extra free variables, while the additive ones
+ * add one generator each
+ *
+ * @param[in] vars variables appearing in the transforming function
+ * @param[in] f transforming function
+ * @param[in] dists per-step disturbances (NULL if none)
+ * @returns zonotope containing f(Z) with at most max_gens generators
+ */
+Zonotope* Zonotope::transform(lst vars, lst f, disturbance_box *dists){
+
+	lst genFun = this->getGeneratorFunction();
+
+	lst free_vars = this->alpha;
+	if( dists != NULL ){
+		for(int i=0; i<(signed)dists->deltas.nops(); i++){
+			if( !dists->additive[i] ){
+				free_vars.append(dists->deltas[i]);
+			}
+		}
+	}
+	int m = free_vars.nops();
+
+	lst sub, center, centered, beta;
+	for(int k=0; k<(signed)vars.nops(); k++){
+		sub.append(vars[k] == genFun[k]);
+	}
+	for(int i=0; i<m; i++){
+		ostringstream name;
+		name<<"zb"<<i+1;
+		beta.append(symbol(name.str()));
+		center.append(free_vars[i] == 0.5);
+		centered.append(free_vars[i] == beta[i] + 0.5);
+	}
+
+	vector< double > newq (this->dim);
+	vector< vector< double > > newG (m,vector< double > (this->dim));
+	vector< double > widths (this->dim);
+
+	for(int k=0; k<this->dim; k++){
+
+		ex fog = f[k].subs(sub).expand();
+
+		// affine part at the center of the generator space
+		double c = ex_to<numeric>(evalf(fog.subs(center))).to_double();
+		ex affine = c;
+		double shift = c;
+		for(int i=0; i<m; i++){
+			double d = ex_to<numeric>(evalf(fog.diff(ex_to<symbol>(free_vars[i])).subs(center))).to_double();
+			newG[i][k] = d;
+			affine = affine + d*(free_vars[i] - 0.5);
+			shift = shift - 0.5*d;
+		}
+
+		// bound the remainder
+		ex rem = (fog - affine).subs(centered).expand();
+		double lo, hi;
+		Zonotope::centeredBound(ControlPointCache::compress(rem,beta,m),lo,hi);
+
+		newq[k] = shift + lo;
+		widths[k] = hi - lo;
+	}
+
+	if( dists != NULL ){	// additive disturbances: D*lb + D*(ub-lb)*delta
+		for(int i=0; i<(signed)dists->lb.size(); i++){
+			if( dists->additive[i] ){
+				vector< double > dist_gen (this->dim);
+				for(int k=0; k<this->dim; k++){
+					newq[k] += dists->D[k][i]*dists->lb[i];
+					dist_gen[k] = dists->D[k][i]*(dists->ub[i] - dists->lb[i]);
+				}
+				newG.push_back(dist_gen);
+			}
+		}
+	}
+
+	for(int k=0; k<this->dim; k++){
+		if( widths[k] > 0 ){
+			vector< double > box_gen (this->dim,0);
+			box_gen[k] = widths[k];
+			newG.push_back(box_gen);
+		}
+	}
+
+	Zonotope *Z = new Zonotope(newq,newG,this->max_gens);
+	Zonotope *R = Z->reduceOrder();
+	delete Z;
+
+	return R;
+}
+
+/**
+ * Interval bound of a polynomial over [-1/2,1/2]^n, term by term: a monomial
+ * of total degree d ranges in [0,2^-d] if all its exponents are even and in
+ * [-2^-d,2^-d] otherwise
+ *
+ * @param[in] p polynomial in compact form
+ * @param[out] lo lower bound
+ * @param[out] hi upper bound
+ */
+void Zonotope::centeredBound(const compact_poly &p, double &lo, double &hi){
+
+	lo = 0;
+	hi = 0;
+	if( p.coeffs.empty() ){
+		return;
+	}
+
+	int n = p.exps.size()/p.coeffs.size();
+	for(int t=0; t<(signed)p.coeffs.size(); t++){
+		int degree = 0;
+		bool even = true;
+		for(int k=0; k<n; k++){
+			degree += p.exps[t*n + k];
+			even = even && (p.exps[t*n + k] % 2 == 0);
+		}
+		double c = p.coeffs[t];
+		double mag = ldexp(fabs(c),-degree);
+		if( degree == 0 ){
+			lo += c;
+			hi += c;
+		}else if( even ){
+			lo += c > 0 ? 0.0 : -mag;
+			hi += c > 0 ? mag : 0.0;
+		}else{
+			lo -= mag;
+			hi += mag;
+		}
+	}
+}
+
+/**
+ * Scalar product of two vectors
+ *
+ * @param[in] v1 first vector
+ * @param[in] v2 second vector
+ * @returns v1*v2
+ */
+double Zonotope::prod(vector<double> v1, vector<double> v2){
+	double res = 0;
+	for(int i=0; i<(signed)v1.size(); i++){
+		res += v1[i]*v2[i];
+	}
+	return res;
+}
@@ -8,10 +8,16 @@
 
 #include <stdio.h>
 #include <iostream>
+#include <unistd.h>
 
 #include "Common.h"
 #include "Bundle.h"
 #include "Sapo.h"
+#include "FlowpipeDiff.h"
+#include "Benchmark.h"
+#include "JobScheduler.h"
+#include "AutoTuner.h"
+#include "ModelCompiler.h"
 
 #include "VanDerPol.h"
 #include "Rossler.h"
@@ -24,6 +30,8 @@
 #include "Influenza.h"
 #include "Ebola.h"
 
+#include "SaturatedOscillator.h"
+
 using namespace std;
 
 int main(int argc,char** argv){
@@ -32,9 +40,139 @@ int main(int argc,char** argv){
   sapo_opt options;
   options.trans = 1;			 // Set transformation (0=OFO, 1=AFO)
   options.decomp = 0;			  // Template decomposition (0=no, 1=yes)
-  //options.alpha = 0.5;		// Weight for bundle size/orthgonal proximity
+  options.alpha = 0.5;		// Weight for bundle size/orthgonal proximity
   options.verbose = false;
+  options.trace = false;         // Log the internals of the Bernstein conversion (floods the log)
+  options.threads = 1;           // Threads for the LPs (<=0: one for each core)
+  options.zonotope_gens = 0;     // Generators of the zonotope member (0=none)
+  options.perf_counters = false; // Hardware counters report (Linux perf_event_open)
+  options.mem_report = false;    // Memory report of each subsystem
+  options.mem_metrics = "";      // File of the per-step memory metrics (empty=none)
+  options.lookahead = 1;         // Steps bounded at once by composing the dynamics (1=none)
+  options.lookahead_degree = 0;  // Total degree kept in the composed dynamics (0=all)
+  options.lookahead_inter = false; // Bound the intermediate steps from the same set
+  options.cache_mb = 0;          // Memory budget of each control points cache in MB (0=unlimited)
+  options.log_file = "";         // File of the log (empty=stderr)
+  options.monotone = false;      // Corner propagation of box reach sets on which the dynamics are monotone
+  options.refine_intersect = false; // Intersect the parameter refinements of the parallelotopes (false=union)
+
+  // Compare two stored flowpipes: sapo --diff reference candidate [tolerance]
+  if(argc >= 4 && strcmp(argv[1],"--diff") == 0){
+    double tol = argc >= 5 ? atof(argv[4]) : 0.00001;
+    FlowpipeDiff *diff = new FlowpipeDiff(argv[2],argv[3],tol);
+    flowpipe_diff report = diff->compare();
+    diff->print(report);
+    delete diff;
+    exit(report.contained ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  // Benchmark on synthetic models: sapo --bench [steps] [file]
+  if(argc >= 2 && strcmp(argv[1],"--bench") == 0){
+    synthetic_opt base;
+    base.dim = 4; base.degree = 2; base.terms = 2; base.coupling = RING;
+    base.num_dirs = 4; base.num_temps = 1; base.num_params = 0; base.seed = 1;
+    int steps = argc >= 3 ? atoi(argv[2]) : 20;
+    string file_name = argc >= 4 ? argv[3] : "benchmark.json";
+    Benchmark *bench = new Benchmark(options,base,steps,file_name);
+    bench->sweepAll();
+    cout<<"Records appended to "<<file_name<<endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  // Run Table 1 and Table 2 concurrently: sapo --jobs [cores] [history]
+  if(argc >= 2 && strcmp(argv[1],"--jobs") == 0){
+    int cores = argc >= 3 ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    string history = argc >= 4 ? argv[3] : "jobs.history";
+    JobScheduler *scheduler = new JobScheduler(cores,JobScheduler::physicalMemory()*0.8,history);
+    scheduler->add("VanDerPol",new VanDerPol(),300,false,options,1);
+    scheduler->add("Rossler",new Rossler(),250,false,options,1);
+    scheduler->add("SIR",new SIR(false),300,false,options,1);
+    scheduler->add("LotkaVolterra",new LotkaVolterra(),500,false,options,1);
+    scheduler->add("Phosphorelay",new Phosphorelay(),200,false,options,1);
+    scheduler->add("Quadcopter",new Quadcopter(),300,false,options,1);
+    scheduler->add("SIRp",new SIRp(),0,true,options,1);
+    scheduler->add("Influenza",new Influenza(),0,true,options,1);
+    scheduler->add("Ebola",new Ebola(),0,true,options,1);
+    scheduler->run();
+    exit(EXIT_SUCCESS);
+  }
+
+  // Tune the Table 1 models: sapo --tune [steps] [fastest|precise] [target]
+  if(argc >= 2 && strcmp(argv[1],"--tune") == 0){
+    int steps = argc >= 3 ? atoi(argv[2]) : 10;
+    tune_objective objective = (argc >= 4 && strcmp(argv[3],"precise") == 0) ? MOST_PRECISE : FASTEST;
+    double target = argc >= 5 ? atof(argv[4]) : (objective == FASTEST ? 1.05 : 0.1);
+    vector< Model* > tune_models;
+    tune_models.push_back(new VanDerPol());
+    tune_models.push_back(new Rossler());
+    tune_models.push_back(new SIR(false));
+    tune_models.push_back(new LotkaVolterra());
+    tune_models.push_back(new Phosphorelay());
+    tune_models.push_back(new Quadcopter());
+    for(int i=0; i<tune_models.size(); i++){
+      cout<<"Model: "<<tune_models[i]->getName()<<"\n";
+      AutoTuner *tuner = new AutoTuner(tune_models[i],options,steps,objective,target);
+      string profile = string(tune_models[i]->getName()) + ".tune";
+      AutoTuner::saveProfile(profile,tuner->tune());
+      cout<<"Profile stored in "<<profile<<"\n";
+      delete tuner;
+    }
+    exit(EXIT_SUCCESS);
+  }
+
+  // Compile the Table 1 models for the runtime: sapo --compile directory
+  if(argc >= 3 && strcmp(argv[1],"--compile") == 0){
+    vector< Model* > compile_models;
+    compile_models.push_back(new VanDerPol());
+    compile_models.push_back(new Rossler());
+    compile_models.push_back(new SIR(false));
+    compile_models.push_back(new LotkaVolterra());
+    compile_models.push_back(new Phosphorelay());
+    compile_models.push_back(new Quadcopter());
+    for(int i=0; i<compile_models.size(); i++){
+      ModelCompiler *compiler = new ModelCompiler(compile_models[i],options);
+      CompiledModel *compiled = compiler->compile();
+      string file_name = string(argv[2]) + "/" + compile_models[i]->getName() + ".sapm";
+      compiled->save(file_name);
+      cout<<"Model: "<<compile_models[i]->getName()<<"	compiled to "<<file_name<<"\n";
+      delete compiled;
+      delete compiler;
+    }
+    exit(EXIT_SUCCESS);
+  }
 
+  // Reachability of piecewise dynamics: sapo --piecewise [steps] [file]
+  if(argc >= 2 && strcmp(argv[1],"--piecewise") == 0){
+    int steps = argc >= 3 ? atoi(argv[2]) : 300;
+    Model *model = new SaturatedOscillator();
+    cout<<"Model: "<<model->getName()<<"\tReach steps: "<<steps<<"\t";
+    Sapo *sapo = new Sapo(model,options);
+    Flowpipe* flowpipe = sapo->reach(model->getReachSet(),steps);
+    if(argc >= 4){
+      flowpipe->saveToFile(argv[3]);
+    }
+    exit(EXIT_SUCCESS);
+  }
+
+  // Store the Table 1 flowpipes and apply the tuning profiles (sapo --tune)
+  // to the Table 1 runs: sapo [--save directory] [--tuned directory]
+  char *save_dir = NULL;
+  char *tune_dir = NULL;
+  for(int a=1; a<argc; a+=2){
+    if(strcmp(argv[a],"--save") != 0 && strcmp(argv[a],"--tuned") != 0){
+      cout<<"main : unknown argument "<<argv[a];
+      exit (EXIT_FAILURE);
+    }
+    if(a+1 == argc){
+      cout<<"main : missing directory of argument "<<argv[a];
+      exit (EXIT_FAILURE);
+    }
+    if(strcmp(argv[a],"--save") == 0){
+      save_dir = argv[a+1];
+    }else{
+      tune_dir = argv[a+1];
+    }
+  }
 
   cout<<"TABLE 1"<<endl;
   // Load modles
@@ -52,8 +190,24 @@ int main(int argc,char** argv){
 
     cout<<"Model: "<<reach_models[i]->getName()<<"\tReach steps: "<<reach_steps[i]<<"\t";
 
-    Sapo *sapo = new Sapo(reach_models[i],options);
+    sapo_opt model_options = options;     // tuned options (sapo --tuned), if any
+    if(tune_dir != NULL){
+      string profile = string(tune_dir) + "/" + reach_models[i]->getName() + ".tune";
+      if(AutoTuner::loadProfile(profile,model_options)){
+        cout<<"(tuning profile "<<profile<<" applied)\t";
+      }else{
+        cout<<"(no tuning profile "<<profile<<", default options)\t";
+      }
+    }
+
+    Sapo *sapo = new Sapo(reach_models[i],model_options);
     Flowpipe* flowpipe = sapo->reach(reach_models[i]->getReachSet(),reach_steps[i]);	// reachability analysis
+
+    if(save_dir != NULL){
+      char file_name[256];
+      snprintf(file_name,sizeof(file_name),"%s/table1_%d.sfp",save_dir,i);
+      flowpipe->saveToFile(file_name);
+    }
   }
   cout<<"\n";
 
@@ -0,0 +1,67 @@
+/**
+ * @file SaturatedOscillator.cpp
+ * Oscillator with saturated velocity feedback (piecewise dynamics)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "SaturatedOscillator.h"
+
+ SaturatedOscillator::SaturatedOscillator(){
+
+
+   ///// The dynamical system /////
+
+ 	// System dimension (number of variables)
+  strcpy(this->name,"Saturated oscillator");
+ 	int dim_sys = 2;
+ 	// List of state variables
+ 	symbol x("x"), y("y");
+  this->vars = {x, y};
+
+ 	// System's dynamics: u = sat(-2y) \in [-1,1]
+ 	ex dx = x + (y)*0.05;
+ 	lst linear = {dx, y + (-x - 2*y)*0.05};		// |2y| <= 1
+ 	lst upper = {dx, y + (-x - 1)*0.05};		// 2y >= 1
+ 	lst lower = {dx, y + (-x + 1)*0.05};		// 2y <= -1
+ 	this->modeDyns = {linear, upper, lower};
+
+ 	// Guards (the mode is active where they are all non-positive)
+ 	lst linear_guards = {2*y - 1, -2*y - 1};
+ 	lst upper_guards = {1 - 2*y};
+ 	lst lower_guards = {2*y + 1};
+ 	this->modeGuards = {linear_guards, upper_guards, lower_guards};
+
+
+ 	///// Parallelotope bundle for reachable set representation /////
+
+ 	int num_dirs = 4;		// number of bundle directions
+ 	int num_temps = 2;		// number of bundle templates
+
+ 	// Directions matrix
+ 	vector< double > Li (dim_sys,0);
+ 	vector< vector< double > > L (num_dirs,Li);
+ 	L[0][0] = 1;
+ 	L[1][1] = 1;
+ 	L[2][0] = -1; L[2][1] = 1;
+ 	L[3][0] = 1; L[3][1] = 1;
+
+ 	// Template matrix
+ 	vector< int > Ti (dim_sys,0);
+ 	vector< vector< int > > T (num_temps,Ti);
+ 	T[0][0] = 0; T[0][1] = 1;
+ 	T[1][0] = 2; T[1][1] = 3;
+
+ 	// Offsets for the set of initial conditions
+ 	vector< double > offp (num_dirs,0);
+ 	vector< double > offm (num_dirs,0);
+ 	offp[0] = 1.05; offm[0] = -1;
+ 	offp[1] = 1.05; offm[1] = -1;
+ 	offp[2] = 10; offm[2] = 10;
+ 	offp[3] = 10; offm[3] = 10;
+
+ 	Bundle *B = new Bundle(L,offp,offm,T);
+  this->reachSet = B;
+
+ }
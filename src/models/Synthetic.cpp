@@ -0,0 +1,166 @@
+/**
+ * @file Synthetic.cpp
+ * Generation of the variables, dynamics, directions, templates, and
+ * parameters of a synthetic model from its options
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Synthetic.h"
+#include <sstream>
+
+/**
+ * Constructor that generates the model, its initial bundle, and its parameter set.
+ * Each variable evolves as x_i + h*(-x_i + sum of random monomials of coupled variables),
+ * and parameter p_k scales the variables i with i % num_params = k
+ *
+ * @param[in] opt size of the model
+ */
+Synthetic::Synthetic(synthetic_opt opt){
+
+	if( opt.dim < 1 || opt.degree < 1 || opt.num_dirs < opt.dim || opt.num_temps < 1 ){
+		cout<<"Synthetic::Synthetic : dim, degree, num_temps must be positive and num_dirs at least dim";
+		exit (EXIT_FAILURE);
+	}
+
+	// at most one template for each extra direction (and the box)
+	opt.num_temps = min(opt.num_temps,opt.num_dirs - opt.dim + 1);
+	this->opt = opt;
+	srand(opt.seed);
+
+	strcpy(this->name,"Synthetic");
+	int dim_sys = opt.dim;
+	ex h = 0.01;
+
+	///// The dynamical system /////
+
+	// List of state variables and parameters
+	for(int i=0; i<dim_sys; i++){
+		ostringstream name;
+		name<<"x"<<i+1;
+		this->vars.append(symbol(name.str()));
+	}
+	for(int i=0; i<opt.num_params; i++){
+		ostringstream name;
+		name<<"p"<<i+1;
+		this->params.append(symbol(name.str()));
+	}
+
+	// System's dynamics
+	for(int i=0; i<dim_sys; i++){
+
+		vector<int> coupled = this->coupledVars(i);
+		ex rhs = -this->vars[i];
+
+		for(int t=0; t<opt.terms; t++){
+			double c = ((double)(rand() % 1000) / 1000.0) - 0.5;
+			int deg = opt.degree == 1 ? 1 : 2 + t % (opt.degree - 1);	// cover all degrees up to opt.degree
+			ex monomial = c;
+			for(int k=0; k<deg; k++){
+				monomial = monomial*this->vars[coupled[rand() % coupled.size()]];
+			}
+			rhs = rhs + monomial;
+		}
+
+		if( opt.num_params > 0 ){
+			rhs = rhs + 0.1*this->params[i % opt.num_params]*this->vars[i];
+		}
+
+		this->dyns.append(this->vars[i] + rhs*h);
+	}
+
+	///// Parallelotope bundle for reachable set representation /////
+
+	// Directions matrix: the box plus the extra directions x_j +/- x_k
+	vector< double > Li (dim_sys,0);
+	vector< vector< double > > L (opt.num_dirs,Li);
+	for(int i=0; i<dim_sys; i++){
+		L[i][i] = 1;
+	}
+	for(int e=0; e<opt.num_dirs - dim_sys; e++){
+		int j = e % dim_sys;
+		int round = e / dim_sys;
+		int k = (j + 1 + round/2) % dim_sys;
+		L[dim_sys+e][j] = 1;
+		if( k != j ){
+			L[dim_sys+e][k] = round % 2 == 0 ? 1 : -1;
+		}
+	}
+
+	// Template matrix: the box and the box with one extra direction
+	vector< int > Ti (dim_sys,0);
+	vector< vector< int > > T (opt.num_temps,Ti);
+	for(int t=0; t<opt.num_temps; t++){
+		for(int i=0; i<dim_sys; i++){
+			T[t][i] = i;
+		}
+		if( t > 0 ){
+			int e = t - 1;
+			T[t][e % dim_sys] = dim_sys + e;	// keeps the template non-singular
+		}
+	}
+
+	// Offsets for the set of initial conditions (box [0.1,0.11]^dim)
+	vector< double > offp (opt.num_dirs,0);
+	vector< double > offm (opt.num_dirs,0);
+	for(int d=0; d<opt.num_dirs; d++){
+		for(int i=0; i<dim_sys; i++){
+			offp[d] = offp[d] + max(L[d][i]*0.11,L[d][i]*0.1);
+			offm[d] = offm[d] + max(-L[d][i]*0.11,-L[d][i]*0.1);
+		}
+	}
+
+	this->reachSet = new Bundle(L,offp,offm,T);
+
+	///// Initial parameter set (box [0.9,1.1]^num_params) /////
+
+	vector< double > pAi (opt.num_params,0);
+	vector< vector< double > > pA (2*opt.num_params,pAi);
+	vector< double > pb (2*opt.num_params,0);
+	for(int k=0; k<opt.num_params; k++){
+		pA[2*k][k] = 1; pb[2*k] = 1.1;
+		pA[2*k+1][k] = -1; pb[2*k+1] = -0.9;
+	}
+	if( opt.num_params > 0 ){
+		this->paraSet = new LinearSystemSet(new LinearSystem(pA,pb));
+	}else{
+		this->paraSet = new LinearSystemSet();
+	}
+
+	///// Specification /////
+
+	Atom *sigma = new Atom(this->vars[0] - 1,0);
+	this->spec = new Always(0,10,sigma);
+}
+
+/**
+ * Variables that can appear in the monomials of the i-th variable
+ *
+ * @param[in] i variable index
+ * @returns indices of the coupled variables
+ */
+vector<int> Synthetic::coupledVars(int i){
+
+	int n = this->opt.dim;
+	vector<int> coupled;
+	coupled.push_back(i);
+
+	switch( this->opt.coupling ){
+		case CHAIN:
+			if( i > 0 ){ coupled.push_back(i-1); }
+		break;
+		case RING:
+			if( n > 1 ){ coupled.push_back((i+n-1) % n); }
+			if( n > 2 ){ coupled.push_back((i+1) % n); }
+		break;
+		case STAR:
+			if( i > 0 ){ coupled.push_back(0); }
+		break;
+		case RANDOM:
+			coupled.push_back(rand() % n);
+			coupled.push_back(rand() % n);
+		break;
+	}
+	return coupled;
+}
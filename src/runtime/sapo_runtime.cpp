@@ -0,0 +1,90 @@
+/**
+ * @file sapo_runtime.cpp
+ * sapo_runtime: reachability and monitoring of precompiled models (see
+ * sapo --compile) without GiNaC
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+#include "Common.h"
+#include "CompiledModel.h"
+#include "ThreadPool.h"
+
+using namespace std;
+
+int main(int argc,char** argv){
+
+  if(argc < 3){
+    cout<<"Usage: sapo_runtime artifact steps [--threads n] [--save flowpipe] [--monitor trace [tolerance]]\n";
+    exit(EXIT_FAILURE);
+  }
+
+  CompiledModel *model = new CompiledModel(argv[1]);
+  int steps = atoi(argv[2]);
+  char *save_file = NULL;
+  char *trace_file = NULL;
+  double tol = 0.00001;
+  for(int i=3; i<argc; i++){
+    if(strcmp(argv[i],"--threads") == 0 && i+1 < argc){
+      ThreadPool::setThreads(atoi(argv[++i]));
+    }else if(strcmp(argv[i],"--save") == 0 && i+1 < argc){
+      save_file = argv[++i];
+    }else if(strcmp(argv[i],"--monitor") == 0 && i+1 < argc){
+      trace_file = argv[++i];
+      if(i+1 < argc && argv[i+1][0] != '-'){
+        tol = atof(argv[++i]);
+      }
+    }
+  }
+
+  cout<<"Model: "<<model->getName()<<"\tReach steps: "<<steps<<"\t";
+  vector< vector< double > > offps, offms;
+  model->reach(steps,offps,offms);
+  cout<<"Done\n";
+
+  if(save_file != NULL){
+    model->saveFlowpipe(save_file,offps,offms);
+  }
+
+  // the i-th line of the trace is the state at the i-th step
+  if(trace_file != NULL){
+    ifstream trace(trace_file);
+    if(!trace.is_open()){
+      cout<<"sapo_runtime : cannot open "<<trace_file<<"\n";
+      exit(EXIT_FAILURE);
+    }
+    vector< vector< double > > points;
+    string line;
+    while(getline(trace,line)){
+      istringstream values(line);
+      vector< double > point;
+      double v;
+      while(values>>v){
+        point.push_back(v);
+      }
+      if(!point.empty()){
+        points.push_back(point);
+      }
+    }
+
+    vector< double > viol = model->violations(points,offps,offms);
+    int outside = 0;
+    for(int i=0; i<(signed)viol.size(); i++){
+      if(viol[i] > tol){
+        cout<<"Step "<<i<<": outside the reach set by "<<viol[i]<<"\n";
+        outside++;
+      }
+    }
+    cout<<viol.size()<<" states checked, "<<outside<<" outside\n";
+    exit(outside == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  exit(EXIT_SUCCESS);
+}
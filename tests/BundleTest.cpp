@@ -0,0 +1,286 @@
+/**
+ * @file BundleTest.cpp
+ * Regression tests of Bundle: template scores, violations, compositions,
+ * closed-form affine bounds, and pruning of the piecewise modes
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Bundle.h"
+#include "SaturatedOscillator.h"
+#include "Check.h"
+#include <stdlib.h>
+#include <algorithm>
+
+/**
+ * Orthogonal proximity of directions and scores of templates, including
+ * templates with a repeated direction (as produced by the random swaps of
+ * decompose) and nearly parallel directions
+ */
+static void testTemplateScores(){
+
+	double rows[5][2] = {{1,0},{0,1},{1,1},{0.1,1.5},{0.20999999999999996,3.1499999999999995}};
+	vector< vector<double> > L;
+	for(int i=0; i<5; i++){
+		L.push_back(vector<double> (rows[i],rows[i]+2));
+	}
+	vector< vector<int> > T (1,vector<int> (2,0));
+	T[0][1] = 1;
+	Bundle *B = new Bundle(vector<lst> (),L,vector<double> (5,1),vector<double> (5,1),T);
+
+	SparseMatrix Ls (L);
+	CHECK_NEAR(Ls.orthProx(0,1),0,1e-6);
+	CHECK_NEAR(Ls.orthProx(0,2),3.14159265/4,1e-6);
+	CHECK_NEAR(Ls.orthProx(2,2),3.14159265/2,1e-6);
+	CHECK(!isnan(Ls.orthProx(3,4)));	// rounding gives a cosine larger than 1
+	CHECK_NEAR(Ls.orthProx(3,4),3.14159265/2,1e-6);
+
+	// the orthogonal template scores best, a repeated direction worst
+	vector< vector<int> > orth (1,vector<int> (2,0)), skew (orth), repeated (orth);
+	orth[0][1] = 1;
+	skew[0][1] = 2;
+	repeated[0][1] = 0;
+	CHECK_NEAR(B->maxOrthProx(orth),0,1e-6);
+	CHECK(B->maxOrthProx(orth) < B->maxOrthProx(skew));
+	CHECK(B->maxOrthProx(skew) < B->maxOrthProx(repeated));
+	CHECK_NEAR(B->maxOrthProx(repeated),3.14159265/2,1e-6);
+}
+
+/**
+ * Violations of the offsets -offm <= L x <= offp against a scalar loop
+ */
+static void testViolations(){
+
+	double rows[3][2] = {{1,0},{0,1},{1,1}};
+	vector< vector<double> > L;
+	for(int i=0; i<3; i++){
+		L.push_back(vector<double> (rows[i],rows[i]+2));
+	}
+	vector<double> offp (3,1), offm (3,2);
+	vector< vector<int> > T (1,vector<int> (2,0));
+	T[0][1] = 1;
+	Bundle *B = new Bundle(vector<lst> (),L,offp,offm,T);
+
+	vector< vector<double> > points;
+	for(int p=0; p<21; p++){
+		vector<double> x (2);
+		x[0] = -3 + 0.3*p;
+		x[1] = 2 - 0.2*p;
+		points.push_back(x);
+	}
+	vector<double> viol = B->violations(points);
+	vector<bool> in = B->contains(points,0);
+	int mismatches = 0;
+	for(int p=0; p<(signed)points.size(); p++){
+		double ref = -HUGE_VAL;
+		for(int i=0; i<3; i++){
+			double Lx = L[i][0]*points[p][0] + L[i][1]*points[p][1];
+			ref = max(ref,max(Lx - offp[i],-Lx - offm[i]));
+		}
+		mismatches += fabs(viol[p] - ref) > 1e-9 || in[p] != (ref <= 0);
+	}
+	CHECK(mismatches == 0);
+}
+
+/**
+ * Two templates with the same generator along x share the composition of
+ * the component of f that depends on x only
+ */
+static void testSharedCompositions(){
+
+	double rows[4][3] = {{1,0,0},{0,1,0},{0,0,1},{0,1,1}};
+	vector< vector<double> > L;
+	for(int i=0; i<4; i++){
+		L.push_back(vector<double> (rows[i],rows[i]+3));
+	}
+	vector<double> offp (4,1), offm (4,0);
+	offp[3] = 2;
+	vector< vector<int> > T (2,vector<int> (3));
+	T[0][0] = 0; T[0][1] = 1; T[0][2] = 2;
+	T[1][0] = 0; T[1][1] = 1; T[1][2] = 3;
+	Bundle *B = new Bundle(L,offp,offm,T);
+
+	symbol x("x"), y("y"), z("z");
+	lst vars, f;
+	vars = {x, y, z};
+	f = {x - 0.1*x*x, y + 0.1*z, z - 0.1*y*z};
+
+	// static mode: f[0], f[1], f[2] for the first template; f[0] (shared),
+	// f[1], f[1] again (direction y+z), and f[2] for the second one
+	ControlPointCache *cache = new ControlPointCache(0);
+	B->transform(vars,f,cache,0);
+	CHECK(cache->getCompositions() == 7);
+	CHECK(cache->getSharedCompositions() == 2);
+}
+
+/**
+ * Sample points of a bundle by rejection from its bounding box
+ *
+ * @param[in] B bundle
+ * @param[in] n number of points
+ * @returns points of B
+ */
+static vector< vector<double> > sample(Bundle *B, int n){
+
+	vector<double> lb, ub;
+	B->getBundle()->boundingBox(lb,ub);
+
+	vector< vector<double> > points;
+	for(int tries=0; (signed)points.size() < n && tries < 1000*n; tries++){
+		vector< vector<double> > x (1,vector<double> (lb.size()));
+		for(int j=0; j<(signed)lb.size(); j++){
+			x[0][j] = lb[j] + (ub[j] - lb[j])*rand()/RAND_MAX;
+		}
+		if( B->contains(x,0)[0] ){
+			points.push_back(x[0]);
+		}
+	}
+	return points;
+}
+
+/**
+ * The closed-form bound of the affine directions, c0 + sum_i max(0,c_i),
+ * equals the maximum of the Bernstein coefficients of the same composition
+ */
+static void testAffineBound(){
+
+	double rows[3][2] = {{1,0},{0,1},{1,1}};
+	vector< vector<double> > L;
+	for(int i=0; i<3; i++){
+		L.push_back(vector<double> (rows[i],rows[i]+2));
+	}
+	vector<double> offp (3), offm (3);
+	offp[0] = 1; offm[0] = 0;		// x in [0,1]
+	offp[1] = 0.5; offm[1] = 0;		// y in [0,0.5]
+	offp[2] = 1.2; offm[2] = -0.2;	// x + y in [0.2,1.2]
+	vector< vector<int> > T (2,vector<int> (2,0));
+	T[0][1] = 1;
+	T[1][1] = 2;
+	Bundle *B = new Bundle(L,offp,offm,T);
+
+	symbol x("x"), y("y");
+	lst vars, f;
+	vars = {x, y};
+	f = {0.9*x + 0.2*y + 0.1, -0.3*x + 1.1*y};
+
+	vector< vector<double> > values;
+	vector< bound_job > jobs = B->prepareTransform(vars,lst(),f,new ControlPointCache(0),1,NULL,values);
+	CHECK(jobs.size() == 6);
+
+	int not_affine = 0, mismatches = 0;
+	for(int t=0; t<(signed)jobs.size(); t++){
+		not_affine += !jobs[t].controlPts->affine;
+
+		// closed form
+		vector< vector<double> > coeffs = ControlPointCache::evaluate(*jobs[t].controlPts,values[jobs[t].par]);
+		double affine_max = coeffs[0][0], affine_min = coeffs[0][0];
+		for(int c=1; c<(signed)coeffs.size(); c++){
+			affine_max += max(0.0,coeffs[c][0]);
+			affine_min += min(0.0,coeffs[c][0]);
+		}
+
+		// Bernstein coefficients of L f(genFun)
+		Parallelotope *P = B->getParallelotope(jobs[t].par);
+		lst genFun = P->getGeneratorFunction();
+		lst sub, val_sub;
+		for(int j=0; j<2; j++){
+			sub.append(vars[j] == genFun[j]);
+			val_sub.append(P->getQ()[j] == values[jobs[t].par][j]);
+			val_sub.append(P->getBeta()[j] == values[jobs[t].par][2+j]);
+		}
+		ex Lfog = 0;
+		for(int j=0; j<2; j++){
+			Lfog = Lfog + L[jobs[t].dir][j]*f[j].subs(sub);
+		}
+		BaseConverter *BC = new BaseConverter(P->getAlpha(),Lfog.expand());
+		lst bern = BC->getBernCoeffsMatrix();
+		double bern_max = -HUGE_VAL, bern_min = HUGE_VAL;
+		for (lst::const_iterator c = bern.begin(); c != bern.end(); ++c){
+			double v = ex_to<numeric>(evalf((*c).subs(val_sub))).to_double();
+			bern_max = max(bern_max,v);
+			bern_min = min(bern_min,v);
+		}
+		mismatches += fabs(affine_max - bern_max) > 1e-9 || fabs(affine_min - bern_min) > 1e-9;
+	}
+	CHECK(not_affine == 0);
+	CHECK(mismatches == 0);
+}
+
+/**
+ * Successor of a point of SaturatedOscillator, u = sat(-2y)
+ *
+ * @param[in] x point
+ * @returns successor
+ */
+static vector<double> saturatedStep(const vector<double> &x){
+
+	double u = max(-1.0,min(1.0,-2*x[1]));
+	vector<double> y (2);
+	y[0] = x[0] + x[1]*0.05;
+	y[1] = x[1] + (-x[0] + u)*0.05;
+	return y;
+}
+
+/**
+ * The modes whose guards are positive over the bundle are pruned, and the
+ * union of the images of the active modes contains the successors
+ */
+static void testActiveModes(){
+
+	srand(17);
+	Model *model = new SaturatedOscillator();
+	lst vars = model->getVars();
+	vector<lst> fs = model->getModeDyns();
+	vector<lst> guards = model->getModeGuards();
+
+	// initial set, y in [1,1.05]: only the upper saturation is active
+	Bundle *B = model->getReachSet();
+	vector<bool> active = B->activeModes(vars,guards,new ControlPointCache(0));
+	CHECK(!active[0] && active[1] && !active[2]);
+
+	// y in [0.4,0.6] crosses 2y = 1: the lower saturation is pruned
+	vector<double> offp, offm;
+	vector< vector<int> > T;
+	for(int i=0; i<B->getSize(); i++){
+		offp.push_back(B->getOffp(i));
+		offm.push_back(B->getOffm(i));
+	}
+	for(int i=0; i<B->getCard(); i++){
+		T.push_back(B->getTemplate(i));
+	}
+	offp[1] = 0.6; offm[1] = -0.4;
+	Bundle *S = new Bundle(B->getDirections(),offp,offm,T);
+	active = S->activeModes(vars,guards,new ControlPointCache(0));
+	CHECK(active[0] && active[1] && !active[2]);
+
+	Bundle *Xs[2] = {B,S};
+	int expected_active[2] = {1,2};
+	for(int k=0; k<2; k++){
+		vector< ControlPointCache* > caches;
+		for(int m=0; m<(signed)fs.size(); m++){
+			caches.push_back(new ControlPointCache(0));
+		}
+		int num_active;
+		Bundle *Y = Xs[k]->transform(vars,lst(),fs,guards,NULL,caches,new ControlPointCache(0),1,num_active);
+		CHECK(num_active == expected_active[k]);
+
+		vector< vector<double> > points = sample(Xs[k],200);
+		for(int s=0; s<(signed)points.size(); s++){
+			points[s] = saturatedStep(points[s]);
+		}
+		vector<bool> in = Y->contains(points,1e-9);
+		CHECK(count(in.begin(),in.end(),false) == 0);
+	}
+}
+
+int main(){
+
+	testTemplateScores();
+	testViolations();
+	testSharedCompositions();
+	testAffineBound();
+	testActiveModes();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,30 @@
+/**
+ * @file Check.h
+ * Minimal assertions of the regression tests (one executable per test file,
+ * run by ctest, failing with a non-zero exit code)
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <iostream>
+#include <math.h>
+
+static int check_failures = 0;
+
+#define CHECK(cond) \
+	do{ \
+		if( !(cond) ){ \
+			std::cout<<__FILE__<<":"<<__LINE__<<" : check failed: "<<#cond<<"\n"; \
+			check_failures++; \
+		} \
+	}while(0)
+
+#define CHECK_NEAR(a, b, tol) CHECK( fabs((a) - (b)) <= (tol) )
+
+#define CHECK_RESULT() (check_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+#endif /* CHECK_H_ */
@@ -0,0 +1,79 @@
+/**
+ * @file CompiledModelTest.cpp
+ * Regression tests of the compiled models: a step of the runtime must
+ * match the transformation of the analysis
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "ModelCompiler.h"
+#include "VanDerPol.h"
+#include "SIRp.h"
+#include "Check.h"
+
+/**
+ * Options of the tests (dynamic transformation, no decomposition)
+ *
+ * @returns options
+ */
+static sapo_opt testOptions(){
+
+	sapo_opt options;
+	options.trans = 1;
+	options.decomp = 0;
+	options.alpha = 0.5;
+	options.verbose = false;
+	return options;
+}
+
+/**
+ * Compare one step of the compiled model (also after storing and loading
+ * it) with the transformation of the initial bundle
+ *
+ * @param[in] model model to compile
+ * @param[in] file_name file of the artifact
+ */
+static void compareStep(Model *model, string file_name){
+
+	sapo_opt options = testOptions();
+	ModelCompiler *compiler = new ModelCompiler(model,options);
+	CompiledModel *compiled = compiler->compile();
+	compiled->save(file_name);
+	CompiledModel *loaded = new CompiledModel(file_name);
+
+	Bundle *B = model->getReachSet();
+	ControlPointCache *cache = new ControlPointCache(0);
+	Bundle *X;
+	if( model->getParams().nops() > 0 ){
+		X = B->transform(model->getVars(),model->getParams(),model->getDyns(),model->getParaSet()->at(0),cache,options.trans,NULL);
+	}else{
+		X = B->transform(model->getVars(),model->getDyns(),cache,options.trans,NULL);
+	}
+
+	vector<double> offp, offm, loaded_offp, loaded_offm;
+	for(int i=0; i<B->getSize(); i++){
+		offp.push_back(B->getOffp(i));
+		offm.push_back(B->getOffm(i));
+	}
+	loaded_offp = offp;
+	loaded_offm = offm;
+	compiled->step(offp,offm);
+	loaded->step(loaded_offp,loaded_offm);
+
+	CHECK((signed)offp.size() == X->getSize());
+	int mismatches = 0;
+	for(int i=0; i<X->getSize(); i++){
+		mismatches += fabs(offp[i] - X->getOffp(i)) > 1e-9 || fabs(offm[i] - X->getOffm(i)) > 1e-9;
+		mismatches += loaded_offp[i] != offp[i] || loaded_offm[i] != offm[i];
+	}
+	CHECK(mismatches == 0);
+}
+
+int main(){
+
+	compareStep(new VanDerPol(),"VanDerPol.sapm");	// affine and nonlinear directions
+	compareStep(new SIRp(),"SIRp.sapm");			// parametric
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,86 @@
+/**
+ * @file FlowpipeDiffTest.cpp
+ * Regression tests of FlowpipeDiff: containment, violations and flowpipes
+ * of different lengths
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "FlowpipeDiff.h"
+#include "Check.h"
+
+#include <fstream>
+
+/**
+ * Write a flowpipe of boxes in the format of Flowpipe::saveToFile
+ *
+ * @param[in] file_name output file
+ * @param[in] offs offsets of each step (the same for all the directions and signs)
+ * @param[in] extra_bytes bytes of an incomplete last step
+ */
+static void writeBoxes(const char *file_name, vector< double > offs, int extra_bytes){
+
+	int version = 1, dim = 2, num_dirs = 2;
+	double L[2][2] = {{1,0},{0,1}};
+
+	ofstream out (file_name, ios_base::out | ios_base::binary);
+	out.write("SAPF",4);
+	out.write((char*)&version,sizeof(int));
+	out.write((char*)&dim,sizeof(int));
+	out.write((char*)&num_dirs,sizeof(int));
+	out.write((char*)L,sizeof(L));
+	for(int i=0; i<(signed)offs.size(); i++){
+		vector< double > step (2*num_dirs,offs[i]);
+		out.write((char*)&step[0],step.size()*sizeof(double));
+	}
+	vector< char > partial (extra_bytes,0);
+	out.write(&partial[0],extra_bytes);
+	out.close();
+}
+
+static flowpipe_diff compare(const char *ref, const char *cand){
+	FlowpipeDiff diff ((char*)ref,(char*)cand,1e-6);
+	return diff.compare();
+}
+
+int main(){
+
+	double ref[] = {1, 2, 3};
+	double wider[] = {1.5, 2.5, 3.5};
+	double narrower[] = {1, 1, 3};
+
+	writeBoxes("diff_ref.sfp",vector< double > (ref,ref+3),0);
+	writeBoxes("diff_wider.sfp",vector< double > (wider,wider+3),0);
+	writeBoxes("diff_narrower.sfp",vector< double > (narrower,narrower+3),0);
+	writeBoxes("diff_short.sfp",vector< double > (wider,wider+2),0);
+	writeBoxes("diff_partial.sfp",vector< double > (wider,wider+2),12);
+
+	// containment of a wider flowpipe
+	flowpipe_diff d = compare("diff_ref.sfp","diff_wider.sfp");
+	CHECK(d.contained);
+	CHECK(d.steps == 3 && d.ref_steps == 3 && d.cand_steps == 3);
+	CHECK_NEAR(d.max_width_ratio[0],1.5,1e-9);
+
+	// violation at the second step
+	d = compare("diff_ref.sfp","diff_narrower.sfp");
+	CHECK(!d.contained);
+	CHECK(d.first_violation == 1);
+
+	// a shorter candidate does not contain the reference
+	d = compare("diff_ref.sfp","diff_short.sfp");
+	CHECK(!d.contained);
+	CHECK(d.steps == 2 && d.ref_steps == 3 && d.cand_steps == 2);
+
+	// nor a longer one
+	d = compare("diff_short.sfp","diff_ref.sfp");
+	CHECK(!d.contained);
+	CHECK(d.ref_steps == 2 && d.cand_steps == 3);
+
+	// a truncated last step is reported
+	d = compare("diff_short.sfp","diff_partial.sfp");
+	CHECK(!d.contained);
+	CHECK(d.truncated && d.ref_steps == 2 && d.cand_steps == 2);
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,251 @@
+/**
+ * @file LinearSystemTest.cpp
+ * Regression tests of LinearSystem
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "LinearSystem.h"
+#include "LinearSystemSet.h"
+#include <stdlib.h>
+#include "Check.h"
+
+/**
+ * Box lb <= x <= ub as a linear system
+ *
+ * @param[in] lb lower bounds
+ * @param[in] ub upper bounds
+ * @returns linear system of the box
+ */
+static LinearSystem* box(vector<double> lb, vector<double> ub){
+
+	int n = lb.size();
+	vector< vector<double> > A;
+	vector< double > b;
+	for(int i=0; i<n; i++){
+		vector< double > Ai (n,0);
+		Ai[i] = 1;
+		A.push_back(Ai);
+		b.push_back(ub[i]);
+		Ai[i] = -1;
+		A.push_back(Ai);
+		b.push_back(-lb[i]);
+	}
+	return new LinearSystem(A,b);
+}
+
+/**
+ * Emptiness in dimension at most 3, where the clipped polytope is not
+ * enough to decide it
+ */
+static void testLowDimEmptiness(){
+
+	// bounded polytopes
+	LinearSystem *unit = box(vector<double> (2,0),vector<double> (2,1));
+	CHECK(!unit->isEmpty());
+	CHECK_NEAR(unit->volume(),1,1e-9);
+	CHECK(box(vector<double> (1,0),vector<double> (1,-1))->isEmpty());
+
+	// feasible sets outside the clipping box
+	CHECK(!box(vector<double> (1,2e6),vector<double> (1,3e6))->isEmpty());
+	vector<double> lb (2,0), ub (2,1);
+	lb[0] = 2e6; ub[0] = 3e6;
+	CHECK(!box(lb,ub)->isEmpty());
+	lb = vector<double> (3,0); ub = vector<double> (3,1);
+	lb[2] = -5e6; ub[2] = -4e6;
+	CHECK(!box(lb,ub)->isEmpty());
+
+	// thin sliver 0 <= x - y <= 1e-10 in the unit square: negligible volume, non-empty interior
+	double rows[6][2] = {{1,-1},{-1,1},{1,0},{-1,0},{0,1},{0,-1}};
+	double offs[6] = {1e-10,0,1,0,1,0};
+	vector< vector<double> > A;
+	for(int i=0; i<6; i++){
+		A.push_back(vector<double> (rows[i],rows[i]+2));
+	}
+	CHECK(!(new LinearSystem(A,vector<double> (offs,offs+6)))->isEmpty());
+
+	// the sliver with inconsistent offsets is empty
+	offs[0] = -1e-3;
+	CHECK((new LinearSystem(A,vector<double> (offs,offs+6)))->isEmpty());
+}
+
+/**
+ * The optima of bounded polytopes of dimension at most 3, computed on the
+ * clipped vertices, are never inside the polytope
+ */
+static void testLowDimOptimize(){
+
+	// triangle x,y >= 0, x/3 + y/7 <= 1 (skewed facet): max x+y = 7, max y-x = 7
+	double rows[3][2] = {{-1,0},{0,-1},{1.0/3,1.0/7}};
+	double offs[3] = {0,0,1};
+	vector< vector<double> > A;
+	for(int i=0; i<3; i++){
+		A.push_back(vector<double> (rows[i],rows[i]+2));
+	}
+	LinearSystem *T = new LinearSystem(A,vector<double> (offs,offs+3));
+	vector<double> c (2,1);
+	double opt = T->maxLinearSystem(c);
+	CHECK(opt >= 7 && opt <= 7 + 1e-6);
+	c[0] = -1;
+	opt = T->maxLinearSystem(c);
+	CHECK(opt >= 7 && opt <= 7 + 1e-6);
+
+	// random 3-D polytopes: the sampled points lie between the optima
+	srand(13);
+	int violations = 0;
+	for(int t=0; t<10; t++){
+		vector< vector<double> > B;
+		vector<double> d;
+		for(int i=0; i<20; i++){
+			vector<double> a (3);
+			for(int j=0; j<3; j++){
+				a[j] = 2.0*rand()/RAND_MAX - 1;
+			}
+			B.push_back(a);
+			d.push_back(0.5 + 1.0*rand()/RAND_MAX);
+		}
+		LinearSystem *P = new LinearSystem(B,d);
+		vector<double> dir (3);
+		for(int j=0; j<3; j++){
+			dir[j] = 2.0*rand()/RAND_MAX - 1;
+		}
+		double hi = P->maxLinearSystem(dir);
+		for(int j=0; j<3; j++){
+			dir[j] = -dir[j];
+		}
+		double lo = -P->maxLinearSystem(dir);
+		for(int j=0; j<3; j++){
+			dir[j] = -dir[j];
+		}
+
+		vector<double> lb, ub;
+		P->boundingBox(lb,ub);
+		for(int s=0; s<1000; s++){
+			vector< vector<double> > x (1,vector<double> (3));
+			for(int j=0; j<3; j++){
+				x[0][j] = lb[j] + (ub[j] - lb[j])*rand()/RAND_MAX;
+			}
+			if( P->contains(x,0)[0] ){
+				double v = dir[0]*x[0][0] + dir[1]*x[0][1] + dir[2]*x[0][2];
+				violations += v > hi || v < lo;
+			}
+		}
+	}
+	CHECK(violations == 0);
+}
+
+/**
+ * Merging systems built separately with the same constraints does not add
+ * rows, and copies share the constraints
+ */
+static void testDeduplication(){
+
+	vector<double> lb (2,0), ub (2,1);
+	LinearSystem *LS = box(lb,ub);
+	LinearSystem *merged = LS;
+	for(int i=0; i<10; i++){
+		merged = merged->appendLinearSystem(box(lb,ub));		// same rows, different blocks
+	}
+	CHECK(merged->size() == 4);
+	CHECK(merged->getA().size() == 4);
+
+	// only the new rows of a partially overlapping system are added
+	ub[0] = 0.5;
+	merged = merged->appendLinearSystem(box(lb,ub));
+	CHECK(merged->size() == 5);
+	CHECK(merged->getb().size() == 5);
+	CHECK_NEAR(merged->maxLinearSystem(vector<double> (2,1)),1.5,1e-8);	// rounded outward by the clipping tolerance
+
+	// the same block is skipped
+	CHECK(merged->appendLinearSystem(merged)->size() == 5);
+
+	// copies
+	LinearSystem copy (*merged);
+	CHECK(copy.size() == 5);
+	CHECK(copy.getA() == merged->getA());
+	LinearSystem assigned;
+	assigned = copy;
+	CHECK(assigned.size() == 5);
+	CHECK_NEAR(assigned.maxLinearSystem(vector<double> (2,1)),1.5,1e-8);
+}
+
+/**
+ * Scalar reference of the violations: max_i (A_i x - b_i)
+ *
+ * @param[in] A constraint matrix
+ * @param[in] b offsets
+ * @param[in] x point
+ * @returns maximum violation of x
+ */
+static double scalarViolation(const vector< vector<double> > &A, const vector<double> &b, const vector<double> &x){
+
+	double v = -HUGE_VAL;
+	for(int i=0; i<(signed)A.size(); i++){
+		double Aix = 0;
+		for(int j=0; j<(signed)x.size(); j++){
+			Aix += A[i][j]*x[j];
+		}
+		v = max(v,Aix - b[i]);
+	}
+	return v;
+}
+
+/**
+ * Batched violations and membership against the scalar reference, on a
+ * number of points that is neither a multiple of the batch nor of the chunk
+ */
+static void testViolations(){
+
+	srand(7);
+	int n = 3, m = 7, num_points = 4096 + 13;
+	vector< vector<double> > A (m,vector<double> (n));
+	vector< double > b (m);
+	for(int i=0; i<m; i++){
+		for(int j=0; j<n; j++){
+			A[i][j] = 2.0*rand()/RAND_MAX - 1;
+		}
+		b[i] = 1.0*rand()/RAND_MAX;
+	}
+	vector< vector<double> > points (num_points,vector<double> (n));
+	for(int p=0; p<num_points; p++){
+		for(int j=0; j<n; j++){
+			points[p][j] = 4.0*rand()/RAND_MAX - 2;
+		}
+	}
+
+	LinearSystem *LS = new LinearSystem(A,b);
+	vector<double> viol = LS->violations(points);
+	vector<bool> in = LS->contains(points,0);
+	CHECK((signed)viol.size() == num_points);
+	CHECK((signed)in.size() == num_points);
+	int mismatches = 0, inside = 0;
+	for(int p=0; p<num_points; p++){
+		double ref = scalarViolation(A,b,points[p]);
+		mismatches += fabs(viol[p] - ref) > 1e-9 || in[p] != (ref <= 0);
+		inside += in[p];
+	}
+	CHECK(mismatches == 0);
+	CHECK(inside > 0 && inside < num_points);
+
+	// a union contains the points of any member
+	LinearSystemSet *S = new LinearSystemSet(box(vector<double> (n,-2),vector<double> (n,-1)));
+	S->add(box(vector<double> (n,1),vector<double> (n,2)));
+	vector< vector<double> > probes (3,vector<double> (n));
+	probes[0] = vector<double> (n,-1.5);
+	probes[1] = vector<double> (n,1.5);
+	probes[2] = vector<double> (n,0);
+	vector<bool> in_set = S->contains(probes,0);
+	CHECK(in_set[0] && in_set[1] && !in_set[2]);
+	CHECK(S->contains(probes,1)[2]);
+}
+
+int main(){
+
+	testLowDimEmptiness();
+	testLowDimOptimize();
+	testDeduplication();
+	testViolations();
+
+	return CHECK_RESULT();
+}
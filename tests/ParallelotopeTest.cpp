@@ -0,0 +1,143 @@
+/**
+ * @file ParallelotopeTest.cpp
+ * Regression tests of Parallelotope: the constraints computed from the
+ * generators describe the same polytope
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Parallelotope.h"
+#include "DenseMatrix.h"
+#include "Check.h"
+#include <sstream>
+
+/**
+ * Variables (q,alpha,beta) of a parallelotope
+ *
+ * @param[in] dim dimension
+ * @returns collections of variables
+ */
+static vector<lst> parallelotopeVars(int dim){
+
+	vector<lst> vars (3);
+	const char *names[3] = {"q","a","b"};
+	for(int k=0; k<3; k++){
+		for(int i=0; i<dim; i++){
+			ostringstream name;
+			name<<names[k]<<i;
+			vars[k].append(symbol(name.str()));
+		}
+	}
+	return vars;
+}
+
+/**
+ * Check gen2const(q,beta) against the generator form q + sum_i a_i beta_i u_i,
+ * a in [0,1]^n: every vertex satisfies the constraints and each facet is
+ * tight exactly at the half of the vertices that lie on it
+ *
+ * @param[in] u versors
+ * @param[in] q base vertex
+ * @param[in] beta generator lengths
+ */
+static void checkGen2const(vector< vector<double> > u, vector<double> q, vector<double> beta){
+
+	int dim = q.size();
+	Parallelotope *P = new Parallelotope(parallelotopeVars(dim),u);
+	LinearSystem *LS = P->gen2const(q,beta);
+	vector< vector<double> > A = LS->getA();
+	vector<double> b = LS->getb();
+	CHECK((signed)A.size() == 2*dim);
+
+	double scale = 1;
+	for(int i=0; i<dim; i++){
+		scale = max(scale,fabs(q[i]) + fabs(beta[i]));
+	}
+
+	vector<int> tight (A.size(),0);
+	int violations = 0;
+	for(int s=0; s<(1<<dim); s++){		// vertex of the subset s of the generators
+		vector<double> v = q;
+		for(int i=0; i<dim; i++){
+			if( s & (1<<i) ){
+				for(int j=0; j<dim; j++){
+					v[j] += beta[i]*u[i][j];
+				}
+			}
+		}
+		for(int r=0; r<(signed)A.size(); r++){
+			double Av = 0, norm = 0;
+			for(int j=0; j<dim; j++){
+				Av += A[r][j]*v[j];
+				norm += fabs(A[r][j]);
+			}
+			violations += Av - b[r] > 1e-9*norm*scale;
+			tight[r] += fabs(Av - b[r]) <= 1e-9*norm*scale;
+		}
+	}
+	CHECK(violations == 0);
+
+	int wrong_facets = 0;
+	for(int r=0; r<(signed)A.size(); r++){
+		wrong_facets += tight[r] != (1<<(dim-1));
+	}
+	CHECK(wrong_facets == 0);
+}
+
+/**
+ * Boxes, skewed parallelotopes, and negative lengths
+ */
+static void testGen2const(){
+
+	// 2-D box
+	vector< vector<double> > u (2,vector<double> (2,0));
+	u[0][0] = 1;
+	u[1][1] = 1;
+	vector<double> q (2), beta (2);
+	q[0] = 1; q[1] = -2;
+	beta[0] = 0.5; beta[1] = 3;
+	checkGen2const(u,q,beta);
+
+	// 2-D nearly degenerate template
+	u[1][0] = 0.995; u[1][1] = 0.0998;
+	beta[1] = -0.25;
+	checkGen2const(u,q,beta);
+
+	// 3-D skewed template
+	u = vector< vector<double> > (3,vector<double> (3,0));
+	u[0][0] = 1;
+	u[1][0] = 0.6; u[1][1] = 0.8;
+	u[2][0] = 0.3; u[2][1] = -0.4; u[2][2] = 0.866;
+	q = vector<double> (3);
+	q[0] = 0.2; q[1] = 100; q[2] = -7;
+	beta = vector<double> (3);
+	beta[0] = 1e-3; beta[1] = 2; beta[2] = 0.7;
+	checkGen2const(u,q,beta);
+}
+
+/**
+ * The singularity test of the inversion does not depend on the scale of the
+ * matrix: tiny regular matrices are inverted, rank-deficient ones are not
+ */
+static void testInvertScale(){
+
+	vector< vector<double> > M (2,vector<double> (2,0)), inv;
+	M[0][0] = 1e-14; M[1][1] = 2e-14;
+	M[0][1] = 1e-14;
+	CHECK(DenseMatrix::invert(M,inv));
+	CHECK_NEAR(inv[0][0]*M[0][0] + inv[0][1]*M[1][0],1,1e-9);
+	CHECK_NEAR(inv[1][0]*M[0][1] + inv[1][1]*M[1][1],1,1e-9);
+
+	M[0][0] = 1e6; M[0][1] = 2e6;
+	M[1][0] = 1e6; M[1][1] = 2e6 + 1e-7;
+	CHECK(!DenseMatrix::invert(M,inv));
+}
+
+int main(){
+
+	testGen2const();
+	testInvertScale();
+
+	return CHECK_RESULT();
+}
@@ -0,0 +1,281 @@
+/**
+ * @file SapoTest.cpp
+ * Regression tests of the reachability analysis and of the parameter
+ * synthesis: the computed sets must contain the images of points sampled
+ * from the initial sets
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Sapo.h"
+#include "SIRp.h"
+#include "Check.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Options of the tests (single thread, no decomposition)
+ *
+ * @returns default options
+ */
+static sapo_opt testOptions(){
+
+	sapo_opt options;
+	options.trans = 1;
+	options.decomp = 0;
+	options.alpha = 0.5;
+	options.verbose = false;
+	return options;
+}
+
+/**
+ * Sample points of a polytope by rejection from its bounding box
+ *
+ * @param[in] S polytope
+ * @param[in] n number of points
+ * @returns points of S
+ */
+static vector< vector<double> > sample(LinearSystem *S, int n){
+
+	vector<double> lb, ub;
+	S->boundingBox(lb,ub);
+
+	vector< vector<double> > points;
+	for(int tries=0; (signed)points.size() < n && tries < 1000*n; tries++){
+		vector< vector<double> > x (1,vector<double> (lb.size()));
+		for(int j=0; j<(signed)lb.size(); j++){
+			x[0][j] = lb[j] + (ub[j] - lb[j])*rand()/RAND_MAX;
+		}
+		if( S->contains(x,1e-9)[0] ){
+			points.push_back(x[0]);
+		}
+	}
+	return points;
+}
+
+/**
+ * Image of a point through the dynamics
+ *
+ * @param[in] vars variables
+ * @param[in] params parameters
+ * @param[in] f dynamics
+ * @param[in] x point
+ * @param[in] p parameter values
+ * @returns f(x,p)
+ */
+static vector<double> image(lst vars, lst params, lst f, const vector<double> &x, const vector<double> &p){
+
+	lst sub;
+	for(int j=0; j<(signed)vars.nops(); j++){
+		sub.append(vars[j] == x[j]);
+	}
+	for(int k=0; k<(signed)params.nops(); k++){
+		sub.append(params[k] == p[k]);
+	}
+	vector<double> y;
+	for(int i=0; i<(signed)f.nops(); i++){
+		y.push_back(ex_to<numeric>(evalf(f[i].subs(sub))).to_double());
+	}
+	return y;
+}
+
+/**
+ * Parametric reachability with lookahead 2 on a model whose parameters
+ * multiply the states (f^2 is quadratic in the parameters)
+ */
+static void testParametricLookahead(){
+
+	srand(3);
+	Model *model = new SIRp();
+	sapo_opt options = testOptions();
+	options.lookahead = 2;
+	Sapo *sapo = new Sapo(model,options);
+
+	int k = 4;
+	LinearSystem *paraSet = model->getParaSet()->at(0);
+	Flowpipe *flowpipe = sapo->reach(model->getReachSet(),paraSet,k);
+	CHECK(flowpipe->size() == k/2 + 1);
+
+	LinearSystem *init = model->getReachSet()->getBundle();
+	vector< vector<double> > xs = sample(init,50);
+	vector< vector<double> > ps = sample(paraSet,50);
+	CHECK(xs.size() == 50 && ps.size() == 50);
+
+	int outside = 0;
+	for(int s=0; s<(signed)xs.size(); s++){
+		vector<double> x = xs[s];
+		for(int j=1; j<=k; j++){
+			x = image(model->getVars(),model->getParams(),model->getDyns(),x,ps[s]);
+			if( j % 2 == 0 ){
+				outside += !flowpipe->get(j/2)->contains(vector< vector<double> > (1,x),1e-7)[0];
+			}
+		}
+	}
+	CHECK(outside == 0);
+}
+
+/**
+ * Two-dimensional model on a box (corner propagation tests)
+ */
+class BoxModel : public Model {
+
+public:
+
+	/**
+	 * Constructor that instantiates the model
+	 *
+	 * @param[in] vars variables
+	 * @param[in] dyns dynamics
+	 * @param[in] lo lower corner of the initial box
+	 * @param[in] hi upper corner of the initial box
+	 */
+	BoxModel(lst vars, lst dyns, vector<double> lo, vector<double> hi){
+		strcpy(this->name,"Box");
+		this->vars = vars;
+		this->dyns = dyns;
+		vector< vector<double> > L (2,vector<double> (2,0));
+		L[0][0] = 1;
+		L[1][1] = 1;
+		vector<double> offp (hi), offm (2);
+		offm[0] = -lo[0];
+		offm[1] = -lo[1];
+		vector< vector<int> > T (1,vector<int> (2,0));
+		T[0][1] = 1;
+		this->reachSet = new Bundle(L,offp,offm,T);
+		this->paraSet = NULL;
+		this->spec = NULL;
+	}
+};
+
+/**
+ * Corner propagation: the boxes of a monotone map contain the sampled
+ * images and every step is certified, while a map whose derivative changes
+ * sign over the box falls back to the Bernstein transformation
+ */
+static void testMonotone(){
+
+	srand(19);
+	symbol x("x"), y("y");
+	lst vars, monotone, non_monotone;
+	vars = {x, y};
+	monotone = {x + 0.1*y - 0.05*x*x, y - 0.1*x*y};		// f1 increasing in x and y, f2 decreasing in x and increasing in y
+	non_monotone = {x - 2*(x - 0.5)*(x - 0.5), y};			// df1/dx = 3 - 4x changes sign at x = 0.75
+	vector<double> lo (2), hi (2);
+	lo[0] = 0.5; hi[0] = 1;
+	lo[1] = 0.2; hi[1] = 0.4;
+	lst dyns[2] = {monotone, non_monotone};
+	int steps[2] = {3, 1};
+	int certified[2] = {3, 0};
+
+	for(int m=0; m<2; m++){
+		if( m == 1 ){
+			lo[0] = 0.2; hi[0] = 0.8;
+		}
+		Model *model = new BoxModel(vars,dyns[m],lo,hi);
+		sapo_opt options = testOptions();
+		options.monotone = true;
+		Sapo *sapo = new Sapo(model,options);
+
+		int k = steps[m];
+		Flowpipe *flowpipe = sapo->reach(model->getReachSet(),k);
+		CHECK(sapo->getMonotoneSteps() == certified[m]);
+
+		vector< vector<double> > xs = sample(model->getReachSet()->getBundle(),100);
+		int outside = 0;
+		for(int s=0; s<(signed)xs.size(); s++){
+			vector<double> p = xs[s];
+			for(int j=1; j<=k; j++){
+				p = image(vars,lst(),dyns[m],p,vector<double> ());
+				outside += !flowpipe->get(j)->contains(vector< vector<double> > (1,p),1e-9)[0];
+			}
+		}
+		CHECK(outside == 0);
+	}
+}
+
+/**
+ * Box of the parameters of SIRp
+ *
+ * @param[in] beta_lb lower bound of beta
+ * @param[in] beta_ub upper bound of beta
+ * @param[in] gamma_lb lower bound of gamma
+ * @param[in] gamma_ub upper bound of gamma
+ * @returns parameter box
+ */
+static LinearSystem* parameterBox(double beta_lb, double beta_ub, double gamma_lb, double gamma_ub){
+
+	vector< vector<double> > A (4,vector<double> (2,0));
+	vector<double> b (4);
+	A[0][0] = 1; b[0] = beta_ub;
+	A[1][0] = -1; b[1] = -beta_lb;
+	A[2][1] = 1; b[2] = gamma_ub;
+	A[3][1] = -1; b[3] = -gamma_lb;
+	return new LinearSystem(A,b);
+}
+
+/**
+ * The intersection of the refinements of the parallelotopes of a bundle
+ * is contained in their union: the bundle is a box of SIRp and its
+ * rotation in the (s,i) plane, and the atom is decided differently on them
+ */
+static void testRefineIntersection(){
+
+	srand(7);
+	Model *model = new SIRp();
+
+	vector< vector<double> > L (5,vector<double> (3,0));
+	vector<double> offp (5), offm (5);
+	L[0][0] = 0.7071; L[0][1] = 0.7071;		// s + i in [0.98,1]
+	offp[0] = 0.7071*1.0; offm[0] = -0.7071*0.98;
+	L[1][0] = -0.7071; L[1][1] = 0.7071;	// i - s in [-0.61,-0.59]
+	offp[1] = -0.7071*0.59; offm[1] = 0.7071*0.61;
+	L[2][2] = 1;							// r = 0
+	offp[2] = 0; offm[2] = 0;
+	L[3][0] = 1;							// s in [0.79,0.8]
+	offp[3] = 0.8; offm[3] = -0.79;
+	L[4][1] = 1;							// i in [0.19,0.2]
+	offp[4] = 0.2; offm[4] = -0.19;
+	vector< vector<int> > T (2,vector<int> (3));
+	T[0][0] = 0; T[0][1] = 1; T[0][2] = 2;
+	T[1][0] = 3; T[1][1] = 4; T[1][2] = 2;
+	Bundle *B = new Bundle(L,offp,offm,T);
+
+	vector<LinearSystem*> boxes;
+	for(int j=0; j<2; j++){
+		for(int k=0; k<2; k++){
+			boxes.push_back(parameterBox(0.18+0.01*j,0.19+0.01*j,0.05+0.005*k,0.055+0.005*k));
+		}
+	}
+
+	Atom *sigma = new Atom(model->getVars()[1] - 0.202,0);	// i <= 0.202 at the next step
+
+	sapo_opt options = testOptions();
+	Sapo *sapo_union = new Sapo(model,options);
+	LinearSystemSet *united = sapo_union->synthesize(B,new LinearSystemSet(boxes),sigma);
+	options.refine_intersect = true;
+	Sapo *sapo_intersect = new Sapo(model,options);
+	LinearSystemSet *intersected = sapo_intersect->synthesize(B,new LinearSystemSet(boxes),sigma);
+	CHECK(!united->isEmpty());
+
+	// sampled points of the intersection belong to the union
+	int outside = 0;
+	vector<LinearSystem*> sets = intersected->getSet();
+	for(int j=0; j<(signed)sets.size(); j++){
+		vector< vector<double> > ps = sample(sets[j],100);
+		vector<bool> in = united->contains(ps,1e-9);
+		for(int s=0; s<(signed)in.size(); s++){
+			outside += !in[s];
+		}
+	}
+	CHECK(outside == 0);
+}
+
+int main(){
+
+	testParametricLookahead();
+	testMonotone();
+	testRefineIntersection();
+
+	return CHECK_RESULT();
+}
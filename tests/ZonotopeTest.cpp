@@ -0,0 +1,160 @@
+/**
+ * @file ZonotopeTest.cpp
+ * Regression tests of Zonotope: support functions, order reduction, and
+ * soundness of the transformation
+ *
+ * @author Tommaso Dreossi <tommasodreossi@berkeley.edu>
+ * @version 0.1
+ */
+
+#include "Zonotope.h"
+#include "Check.h"
+#include <stdlib.h>
+
+/**
+ * Random unit direction
+ *
+ * @param[in] dim dimension
+ * @returns direction
+ */
+static vector<double> randomDirection(int dim){
+
+	vector<double> l (dim);
+	double norm = 0;
+	for(int j=0; j<dim; j++){
+		l[j] = 2.0*rand()/RAND_MAX - 1;
+		norm += l[j]*l[j];
+	}
+	for(int j=0; j<dim; j++){
+		l[j] = l[j]/sqrt(norm);
+	}
+	return l;
+}
+
+/**
+ * Random point q + G alpha of a zonotope
+ *
+ * @param[in] Z zonotope
+ * @returns point of Z
+ */
+static vector<double> randomPoint(Zonotope *Z){
+
+	vector<double> x = Z->getBasePoint();
+	vector< vector<double> > G = Z->getGenerators();
+	for(int i=0; i<(signed)G.size(); i++){
+		double a = (rand() % 4 == 0) ? (rand() % 2) : 1.0*rand()/RAND_MAX;	// some vertices
+		for(int j=0; j<(signed)x.size(); j++){
+			x[j] += a*G[i][j];
+		}
+	}
+	return x;
+}
+
+/**
+ * Support function against its definition on a box and a skewed zonotope
+ */
+static void testSupport(){
+
+	vector< vector<double> > G (2,vector<double> (2,0));
+	G[0][0] = 2;
+	G[1][1] = 1;
+	Zonotope *box = new Zonotope(vector<double> (2,-1),G,2);
+	vector<double> l (2);
+	l[0] = 1;
+	l[1] = -1;
+	CHECK_NEAR(box->support(l),1 + 1,1e-12);	// x = 1, y = -1
+
+	G.push_back(vector<double> (2,1));
+	Zonotope *Z = new Zonotope(vector<double> (2,0),G,3);
+	l[0] = 1;
+	l[1] = 1;
+	CHECK_NEAR(Z->support(l),2 + 1 + 2,1e-12);
+	l[0] = -1;
+	l[1] = 0;
+	CHECK_NEAR(Z->support(l),0,1e-12);
+
+	// no sampled point exceeds the support
+	int violations = 0;
+	for(int s=0; s<500; s++){
+		vector<double> x = randomPoint(Z);
+		vector<double> d = randomDirection(2);
+		violations += d[0]*x[0] + d[1]*x[1] > Z->support(d) + 1e-12;
+	}
+	CHECK(violations == 0);
+}
+
+/**
+ * The reduced zonotope has at most max_gens generators and contains the
+ * original one (its support is never smaller)
+ */
+static void testReduceOrder(){
+
+	srand(11);
+	int dim = 3, gens = 9;
+	vector< vector<double> > G;
+	for(int i=0; i<gens; i++){
+		G.push_back(randomDirection(dim));
+	}
+	Zonotope *Z = new Zonotope(vector<double> (dim,0.5),G,5);
+	Zonotope *R = Z->reduceOrder();
+	CHECK(R->getNumGens() <= 5);
+
+	int violations = 0;
+	for(int s=0; s<1000; s++){
+		vector<double> l = randomDirection(dim);
+		violations += R->support(l) < Z->support(l) - 1e-12;
+	}
+	CHECK(violations == 0);
+}
+
+/**
+ * The image of a zonotope through nonlinear dynamics contains the images
+ * of the sampled points of the zonotope
+ */
+static void testTransform(){
+
+	srand(5);
+	symbol x("x"), y("y");
+	lst vars, f;
+	vars = {x, y};
+	f = {x + 0.1*y*y - 0.05*x*y, y - 0.1*x*y*y + 0.02*x*x*x};
+
+	vector< vector<double> > G (3,vector<double> (2,0));
+	G[0][0] = 0.4;
+	G[1][1] = 0.3;
+	G[2][0] = 0.2; G[2][1] = -0.2;
+	vector<double> q (2);
+	q[0] = 0.8;
+	q[1] = -0.5;
+	Zonotope *Z = new Zonotope(q,G,4);
+	Zonotope *R = Z->transform(vars,f,NULL);
+	CHECK(R->getNumGens() <= 4);
+
+	vector< vector<double> > dirs;
+	for(int k=0; k<64; k++){
+		vector<double> l (2);
+		l[0] = cos(2*M_PI*k/64);
+		l[1] = sin(2*M_PI*k/64);
+		dirs.push_back(l);
+	}
+
+	int violations = 0;
+	for(int s=0; s<500; s++){
+		vector<double> p = randomPoint(Z);
+		double fx = p[0] + 0.1*p[1]*p[1] - 0.05*p[0]*p[1];
+		double fy = p[1] - 0.1*p[0]*p[1]*p[1] + 0.02*p[0]*p[0]*p[0];
+		for(int k=0; k<(signed)dirs.size(); k++){
+			violations += dirs[k][0]*fx + dirs[k][1]*fy > R->support(dirs[k]) + 1e-9;
+		}
+	}
+	CHECK(violations == 0);
+}
+
+int main(){
+
+	testSupport();
+	testReduceOrder();
+	testTransform();
+
+	return CHECK_RESULT();
+}